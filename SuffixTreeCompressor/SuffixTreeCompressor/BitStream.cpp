@@ -0,0 +1,25 @@
+#include "BitStream.h"
+
+BitWriter::BitWriter(vector<uchar> * bytes)
+{
+	this->bytes = bytes;
+	this->accumulator = 0;
+	this->bitCount = 0;
+}
+
+void BitWriter::Flush()
+{
+	if (bitCount > 0)
+	{
+		bytes->push_back((uchar)(accumulator << (8 - bitCount)));
+	}
+
+	accumulator = 0;
+	bitCount = 0;
+}
+
+BitReader::BitReader(const uchar * bytes, long long bitPosition)
+{
+	this->bytes = bytes;
+	this->bitPosition = bitPosition;
+}
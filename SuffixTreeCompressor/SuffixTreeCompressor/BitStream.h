@@ -0,0 +1,179 @@
+#pragma once
+#include <vector>
+
+using namespace std;
+
+typedef unsigned char uchar;
+
+/**
+ * <summary> Writer of bit fields of any width into bytes, most significant bit first. Bits are collected in 64-bit
+ *  accumulator and go out as whole bytes.</summary>
+ */
+
+class BitWriter
+{
+	public:
+		BitWriter() = default;
+
+		/**
+		 * <summary> Constructor.</summary>
+		 *
+		 * <param name="bytes"> The bytes to append to.</param>
+		 */
+
+		BitWriter(vector<uchar> * bytes);
+
+		/**
+		 * <summary> Writes bit field.</summary>
+		 *
+		 * <param name="value"> The value - only the lowest count bits may be set.</param>
+		 * <param name="count"> Number of bits (0-64).</param>
+		 */
+
+		void Write(unsigned long long value, short count);
+
+		/**
+		 * <summary> Writes out the last bits - the rest of the last byte is zero.</summary>
+		 */
+
+		void Flush();
+
+	private:
+		vector<uchar> * bytes;			///< The output bytes
+		unsigned long long accumulator;	///< Bits that are not written yet (the lowest bitCount bits)
+		short bitCount;					///< Number of bits in accumulator (less than 8 between writes)
+};
+
+/**
+ * <summary> Reader of bit fields written by BitWriter. Any position is read by one unaligned 64-bit load, so there is no
+ *  refill branch - the bytes have to be followed by PaddingBytes readable bytes.</summary>
+ */
+
+class BitReader
+{
+	public:
+		static const int PaddingBytes = 8;		///< Bytes behind the data that the reader may touch
+		static const short MaxPeekBits = 57;	///< The widest field read by one load
+
+		BitReader() = default;
+
+		/**
+		 * <summary> Constructor.</summary>
+		 *
+		 * <param name="bytes">		  The bytes (followed by PaddingBytes).</param>
+		 * <param name="bitPosition"> Position of the first bit to read.</param>
+		 */
+
+		BitReader(const uchar * bytes, long long bitPosition = 0);
+
+		/**
+		 * <summary> Gets the next bits without moving forward.</summary>
+		 *
+		 * <param name="count"> Number of bits (1-MaxPeekBits).</param>
+		 *
+		 * <returns> The bits.</returns>
+		 */
+
+		unsigned long long Peek(short count);
+
+		/**
+		 * <summary> Moves forward.</summary>
+		 *
+		 * <param name="count"> Number of bits.</param>
+		 */
+
+		void Skip(long long count);
+
+		/**
+		 * <summary> Reads bit field.</summary>
+		 *
+		 * <param name="count"> Number of bits (0-64).</param>
+		 *
+		 * <returns> The value.</returns>
+		 */
+
+		unsigned long long Read(short count);
+
+		/**
+		 * <summary> Gets number of bytes that are read (the last one may be read partially).</summary>
+		 *
+		 * <returns> The bytes count.</returns>
+		 */
+
+		long long GetBytesRead();
+
+		/**
+		 * <summary> Gets position of the next bit.</summary>
+		 *
+		 * <returns> The bit position.</returns>
+		 */
+
+		long long GetBitPosition();
+
+	private:
+		const uchar * bytes;		///< The input bytes
+		long long bitPosition;		///< Position of the next bit
+};
+
+
+inline void BitWriter::Write(unsigned long long value, short count)
+{
+	//the accumulator takes up to 56 bits at once
+	if (count > 32)
+	{
+		Write(value >> 32, count - 32);
+		count = 32;
+		value &= 0xffffffffULL;
+	}
+
+	accumulator = (accumulator << count) | value;
+	bitCount += count;
+	while (bitCount >= 8)
+	{
+		bitCount -= 8;
+		bytes->push_back((uchar)(accumulator >> bitCount));
+	}
+}
+
+inline unsigned long long BitReader::Peek(short count)
+{
+	const uchar * word = bytes + (bitPosition >> 3);
+	unsigned long long value = 0;
+	for (short i = 0; i < 8; i++)
+	{
+		value = (value << 8) | word[i];
+	}
+
+	return (value << (bitPosition & 7)) >> (64 - count);
+}
+
+inline void BitReader::Skip(long long count)
+{
+	bitPosition += count;
+}
+
+inline unsigned long long BitReader::Read(short count)
+{
+	if (count == 0)
+		return 0;
+
+	if (count > 32)
+	{
+		unsigned long long high = Read(count - 32);
+		return (high << 32) | Read(32);
+	}
+
+	unsigned long long value = Peek(count);
+	bitPosition += count;
+	return value;
+}
+
+inline long long BitReader::GetBytesRead()
+{
+	return (bitPosition + 7) >> 3;
+}
+
+inline long long BitReader::GetBitPosition()
+{
+	return bitPosition;
+}
@@ -0,0 +1,955 @@
+#pragma once
+
+#include <string.h>
+#include <iostream>
+#include <algorithm>
+#include <iomanip>
+#include "MatchFinder.hh"
+#include "HashChainMatchFinder.hh"
+#include "Parsing.h"
+#include "MatchStruct.h"
+#include "Stream.hh"
+#include "Encoder.h"
+#include "OutputBytesHelper.hh"
+#include "LongRangeMatcher.hh"
+#include "StoredBlock.hh"
+#include "Reference.hh"
+#include "CompressionStrategy.h"
+#include "TimeBudget.h"
+#include "BlockIndex.h"
+#include "SuffixTree.hh"
+#include "SuffixTreeAux.hh"
+#include "TokenInputStream.h"
+#include "TokenOutputStream.h"
+
+using namespace std;
+
+/**
+ * <summary> Compressor that reads the input in blocks of window size and lets a block match finder find matches
+ *  for the whole block at once. Output format is the same as of the suffix tree, so decompression is left to it.</summary>
+ */
+
+ //Declaration----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+class BlockCompressor : public SuffixTreeAux
+{
+	public:
+		static const int FastChainDepth = 4;	///< Candidates checked per position by the fast matcher (time budget at risk)
+
+		BlockCompressor(MatchFinder<T> * matchFinder, int windowSize, short slidingWindowSizeBits, short matchLengthSizeBits, ParsingEnum parsing);
+		~BlockCompressor();
+
+		void InitForCompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile, bool compactTree, bool longRange, bool repeatOffsets, bool sequences, bool splitStreams);
+		void InitForDecompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile, bool longRange, bool repeatOffsets, bool sequences, bool splitStreams);
+		void LoadReference(const char * referenceFile, const vector<int> * referenceTokens);
+		void SkipInput(long long bytes);
+		void WriteFrameHeader(FrameHeader header);
+		void SetIndependentBlocks(int blockSymbols);
+		void SetBlocksToDecode(int count);
+		void SetChecksums(bool checksums);
+		void SetEntropyCoding(bool entropyCoding);
+		const vector<unsigned int>& GetDecodedChecksums() const;
+		void FinishCompression();
+		void FinishDecompression();
+		void Compress(long long inputFileSize, bool showProgress, TokenInputStream * inputStream, double timeBudget);
+		void Decompress(long long inputFileSize, bool showProgress, TokenOutputStream * outputStream);
+		void WriteCompressionStatistics();
+		void WriteDecompressionStatistics();
+
+	private:
+		static const int LongRangeItem = -1;	///< Parse length of position where long-range match starts
+
+		MatchFinder<T> * matchFinder;	///< The engine that finds matches in blocks
+		MatchFinder<T> * fastMatchFinder;	///< Hash chains with short chains used when the time budget is at risk (NULL until needed)
+		int windowSize;					///< Size of the sliding window (and of the block)
+		short slidingWindowSizeBits;	///< The sliding window size in bits
+		short matchLengthSizeBits;		///< The number of bits that are occupied by match length
+		short matchBits;				///< Number of bits per one match (index in buffer and length)
+		short matchBytesCount;			///< Number of bytes that match bits take rounded up - shorter matches go out as literals
+		int matchLengthMaxValue;		///< The maximum match length (not to overflow length field with its extension)
+		int escapeLength;				///< The shortest match with length extension - finders may stop at it
+		ParsingEnum parsing;			///< The way matches and literals are chosen
+		T * symbols;					///< History (the last window) followed by the current block
+		int * matchLengths;				///< Longest match length for every position of the block
+		int * matchDistances;			///< Distance of the longest match for every position of the block
+		long long * parseCosts;			///< Encoded size in bits of the rest of the block from every position (optimal parsing)
+		int * parseLengths;				///< Length of the match chosen for every position (0 = literal, LongRangeItem = long-range match)
+		int * cheapestPositions;		///< Positions behind the parsed one whose cost is lower than of all positions in front of them (optimal parsing)
+		InStream<T> inStream;			///< Stream to read data from
+		OutStream<T> outStream;			///< Stream to write data to
+		Encoder encoder;				///< The encoder for matches
+		OutputBytesHelper<T> * outputBytesHelper;	///< The helper for collecting output bytes
+		SuffixTree<T> * decompressor;	///< The suffix tree used for decompression
+		LongRangeMatcher<T> * longRangeMatcher;	///< The pre-pass with long-range matches (NULL if not used)
+		uchar * longRangeBytes;			///< Distance and length bytes of the current long-range match
+		vector<LongRangeMatch> blockLongRangeMatches;	///< Long-range matches that start in the current block
+		long long longRangeMatchEnd;	///< Position behind the last long-range match (it may reach over more blocks)
+		bool storedBlocks;				///< Whether incompressible blocks are stored
+		bool sequences;					///< Whether items are written in sequence layout (no flags, literal run field per match)
+		bool checksums;					///< Whether blocks get checksums in the index
+		bool entropyCoding;				///< Whether the output is entropy coded afterwards
+		Crc32c contentChecksum;			///< Checksum of symbols of the current block
+		StrategyLog blockStrategies;	///< Strategy of every block
+		bool showStrategies;			///< Whether strategies are reported in statistics
+		vector<T> reference;			///< Symbols of the reference file - its last window is history of the first block
+		int blockSymbols;				///< Number of symbols per independent block (zero if the input is not split)
+		long long nextBlockStart;		///< Position of the first symbol of the next independent block
+		BlockIndex blockIndex;			///< Where the independent blocks start
+		long long symbolsProcessed = 0;
+
+		/**
+		 * <summary> Reads the next token - from the long-range pre-pass if it is used, else from the input stream.</summary>
+		 *
+		 * <param name="inputStream"> The input stream.</param>
+		 * <param name="token">		  The token.</param>
+		 *
+		 * <returns> False if there are no more tokens.</returns>
+		 */
+
+		bool ReadToken(TokenInputStream * inputStream, T & token);
+
+		/**
+		 * <summary> Parses the parts of the block between long-range matches that start in it and writes them out with the
+		 *  matches. If stored blocks are available and the parsed block would take more bits than stored one, nothing is
+		 *  written - the caller stores the block.</summary>
+		 *
+		 * <param name="block">		  The block symbols.</param>
+		 * <param name="blockLength"> Number of symbols of the block.</param>
+		 *
+		 * <returns> False if the block has to be stored.</returns>
+		 */
+
+		bool ParseBlock(T * block, int blockLength);
+
+		/**
+		 * <summary> Writes the items chosen by parsing (parseLengths) and the long-range matches of the block out.</summary>
+		 *
+		 * <param name="block">		  The block symbols.</param>
+		 * <param name="start">		  The first position that is not covered by long-range match of the previous block.</param>
+		 * <param name="blockLength"> Number of symbols of the block.</param>
+		 */
+
+		void WriteParsedBlock(T * block, int start, int blockLength);
+
+		/**
+		 * <summary> Writes the block as stored block. The part covered by the last long-range match is left out - the decoder
+		 *  gets it from the match.</summary>
+		 *
+		 * <param name="block">		  The block symbols.</param>
+		 * <param name="blockLength"> Number of symbols of the block.</param>
+		 *
+		 * <returns> Number of symbols at the start of the block covered by the long-range match.</returns>
+		 */
+
+		int WriteStoredBlock(T * block, int blockLength);
+
+		/**
+		 * <summary> Chooses matches and literals for the part of block into parseLengths (greedy or lazy parsing).</summary>
+		 *
+		 * <param name="block"> The block symbols.</param>
+		 * <param name="start"> The first position of the part.</param>
+		 * <param name="end">	 Position behind the part - matches don't reach over it.</param>
+		 *
+		 * <returns> Encoded size of the part in bits.</returns>
+		 */
+
+		long long ParseRange(T * block, int start, int end);
+
+		/**
+		 * <summary> Chooses matches and literals for the part of block with the smallest encoded size into parseLengths. Any shorter
+		 *  match from the same distance is possible too, so the longest match per position is enough for the shortest path.</summary>
+		 *
+		 * <param name="block"> The block symbols.</param>
+		 * <param name="start"> The first position of the part.</param>
+		 * <param name="end">	 Position behind the part - matches don't reach over it.</param>
+		 *
+		 * <returns> Encoded size of the part in bits.</returns>
+		 */
+
+		long long ParseRangeOptimal(T * block, int start, int end);
+
+		/**
+		 * <summary> Estimates encoded size of the items chosen by parsing for the part of block after entropy coding - literals
+		 *  take the given bits (flags stay raw) and match codes, which get shorter too, at most as much as literals of their
+		 *  symbols.</summary>
+		 *
+		 * <param name="start">		  The first position of the part.</param>
+		 * <param name="end">		  Position behind the part.</param>
+		 * <param name="literalBits"> Bits of one entropy coded literal.</param>
+		 *
+		 * <returns> Encoded size of the part in bits.</returns>
+		 */
+
+		long long EntropyCodedBits(int start, int end, short literalBits);
+
+		/**
+		 * <summary> Writes match of the block position out - as repeat code if the same symbols are at one of the last match
+		 *  indices.</summary>
+		 *
+		 * <param name="block">		  The block symbols.</param>
+		 * <param name="position">	  Position in the block.</param>
+		 * <param name="matchLength"> Length of the match.</param>
+		 */
+
+		void WriteMatch(T * block, int position, int matchLength);
+
+		/**
+		 * <summary> Gets one of the last match indices where the same symbols are as at the match - repeat code is shorter than
+		 *  full match code.</summary>
+		 *
+		 * <param name="block">		  The block symbols.</param>
+		 * <param name="position">	  Position in the block.</param>
+		 * <param name="matchLength"> Length of the match.</param>
+		 * <param name="matchIndex">  Index of the match.</param>
+		 *
+		 * <returns> The repeated index, matchIndex if there is none.</returns>
+		 */
+
+		int PreferRepeatOffset(T * block, int position, int matchLength, int matchIndex);
+
+		/**
+		 * <summary> Gets the longest match of the block position - match that the finder stopped at escape length is compared
+		 *  further.</summary>
+		 *
+		 * <param name="block">	   The block symbols.</param>
+		 * <param name="position"> Position in the block.</param>
+		 * <param name="end">	   Position behind the part - the match doesn't reach over it.</param>
+		 *
+		 * <returns> The match length.</returns>
+		 */
+
+		int ExtendMatch(T * block, int position, int end);
+
+		/**
+		 * <summary> Gets encoded size of match in bits together with its flag (literal run field in sequence layout).</summary>
+		 *
+		 * <param name="matchLength"> Length of the match.</param>
+		 *
+		 * <returns> The match cost.</returns>
+		 */
+
+		long long MatchCost(int matchLength);
+
+		/**
+		 * <summary> Gets encoded size of literal in bits together with its flag (sequence layout has literals without flags).</summary>
+		 *
+		 * <returns> The literal cost.</returns>
+		 */
+
+		long long LiteralCost();
+
+		/**
+		 * <summary> Ends the current independent block (if any) and adds the next one to the index. The caller drops the history.</summary>
+		 *
+		 * <param name="inputStream"> The input stream - to get position of the block in the input.</param>
+		 */
+
+		void StartBlock(TokenInputStream * inputStream);
+};
+
+//Definition----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+BlockCompressor<T>::BlockCompressor(MatchFinder<T> * matchFinder, int windowSize, short slidingWindowSizeBits, short matchLengthSizeBits, ParsingEnum parsing)
+{
+	this->matchFinder = matchFinder;
+	this->fastMatchFinder = NULL;
+	this->windowSize = windowSize;
+	this->slidingWindowSizeBits = slidingWindowSizeBits;
+	this->matchLengthSizeBits = matchLengthSizeBits;
+	this->matchBits = slidingWindowSizeBits + 1 + matchLengthSizeBits;
+	this->matchBytesCount = (matchBits + 7) / 8;
+	this->matchLengthMaxValue = Encoder::MaxMatchLength(matchLengthSizeBits);
+	this->escapeLength = (1 << matchLengthSizeBits) - 1;
+	this->parsing = parsing;
+	this->decompressor = NULL;
+	this->longRangeMatcher = NULL;
+	this->longRangeMatchEnd = 0;
+	this->storedBlocks = false;
+	this->sequences = false;
+	this->checksums = false;
+	this->entropyCoding = false;
+	this->showStrategies = false;
+	this->blockSymbols = 0;
+	this->nextBlockStart = 0;
+}
+
+template <typename T>
+BlockCompressor<T>::~BlockCompressor()
+{
+	delete (matchFinder);
+	delete (fastMatchFinder);
+	delete (decompressor);
+}
+
+template <typename T>
+void BlockCompressor<T>::InitForCompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile, bool /*compactTree*/, bool longRange, bool repeatOffsets, bool sequences, bool splitStreams)
+{
+	this->inStream.Open(inFile, true, binaryFile);
+	this->outStream.Open(outFile, true);
+	this->sequences = sequences;
+	this->encoder = Encoder(matchLengthSizeBits, matchBits, repeatOffsets);
+	this->outputBytesHelper = new OutputBytesHelper<T>(outFile, encoder.GetMatchBits(), &outStream, sequences, splitStreams);
+
+	this->symbols = new T[2 * windowSize];
+	this->matchLengths = new int[windowSize];
+	this->matchDistances = new int[windowSize];
+	this->parseCosts = new long long[windowSize + 1];
+	this->parseLengths = new int[windowSize + 1];
+	this->cheapestPositions = new int[windowSize + 1];
+
+	if (longRange)
+	{
+		this->longRangeMatcher = new LongRangeMatcher<T>(windowSize);
+		this->longRangeBytes = new uchar[LongRangeMatcher<T>::ExtraBytesCount];
+	}
+
+	this->storedBlocks = StoredBlock<T>::IsAvailable(windowSize);
+}
+
+template <typename T>
+void BlockCompressor<T>::InitForDecompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile, bool longRange, bool repeatOffsets, bool sequences, bool splitStreams)
+{
+	if (decompressor == NULL)
+	{
+		this->decompressor = new SuffixTree<T>(windowSize, slidingWindowSizeBits, matchLengthSizeBits);
+	}
+	this->decompressor->InitForDecompression(inFile, outFile, matchLengthSizeBits, binaryFile, longRange, repeatOffsets, sequences, splitStreams);
+}
+
+template <typename T>
+void BlockCompressor<T>::LoadReference(const char * referenceFile, const vector<int> * referenceTokens)
+{
+	if (decompressor != NULL)
+	{
+		this->decompressor->LoadReference(referenceFile, referenceTokens);
+		return;
+	}
+
+	Reference<T>::Load(referenceFile, referenceTokens, reference);
+}
+
+template <typename T>
+void BlockCompressor<T>::SkipInput(long long bytes)
+{
+	if (decompressor != NULL)
+	{
+		this->decompressor->SkipInput(bytes);
+		return;
+	}
+
+	inStream.Seek(bytes);
+}
+
+template <typename T>
+void BlockCompressor<T>::WriteFrameHeader(FrameHeader header)
+{
+	uchar bytes[FrameHeader::Size];
+	header.SymbolWidth = sizeof(T);
+	header.BlockSize = (blockSymbols > 0) ? blockSymbols : windowSize;
+	header.Encode(bytes);
+
+	for (short i = 0; i < FrameHeader::Size; i++)
+	{
+		outStream.WriteByte(bytes[i]);
+	}
+}
+
+template <typename T>
+void BlockCompressor<T>::SetIndependentBlocks(int blockSymbols)
+{
+	this->blockSymbols = blockSymbols;
+}
+
+template <typename T>
+void BlockCompressor<T>::SetBlocksToDecode(int count)
+{
+	this->decompressor->SetBlocksToDecode(count);
+}
+
+template <typename T>
+void BlockCompressor<T>::SetChecksums(bool checksums)
+{
+	if (decompressor != NULL)
+	{
+		this->decompressor->SetChecksums(checksums);
+		return;
+	}
+
+	this->checksums = checksums;
+	blockIndex.SetChecksums(checksums);
+}
+
+template <typename T>
+void BlockCompressor<T>::SetEntropyCoding(bool entropyCoding)
+{
+	this->entropyCoding = entropyCoding;
+}
+
+template <typename T>
+const vector<unsigned int>& BlockCompressor<T>::GetDecodedChecksums() const
+{
+	return decompressor->GetDecodedChecksums();
+}
+
+template <typename T>
+void BlockCompressor<T>::FinishCompression()
+{
+	delete[] symbols;
+	delete[] matchLengths;
+	delete[] matchDistances;
+	delete[] parseCosts;
+	delete[] parseLengths;
+	delete[] cheapestPositions;
+	delete (outputBytesHelper);
+
+	if (longRangeMatcher != NULL)
+	{
+		delete[] longRangeBytes;
+		delete (longRangeMatcher);
+	}
+}
+
+template <typename T>
+void BlockCompressor<T>::FinishDecompression()
+{
+	this->decompressor->FinishDecompression();
+}
+
+template <typename T>
+void BlockCompressor<T>::Compress(long long inputFileSize, bool showProgress, TokenInputStream * inputStream, double timeBudget)
+{
+	double donePart = 0;
+	short dashesCount = 0;
+	cout.precision(2);
+
+	if (longRangeMatcher != NULL)
+	{
+		longRangeMatcher->AddReference(reference);
+	}
+
+	if (longRangeMatcher != NULL && inputStream != NULL)
+	{
+		longRangeMatcher->Load(inputStream);
+	}
+	else if (longRangeMatcher != NULL)
+	{
+		longRangeMatcher->Load(&inStream);
+	}
+
+	TimeBudget * budget = (timeBudget > 0) ? new TimeBudget(timeBudget, inputFileSize) : NULL;
+	CompressionStrategyEnum strategy = LevelStrategy;
+	showStrategies = storedBlocks || budget != NULL;
+
+	//the last window of the reference is history of the first block
+	size_t referenceStart = Reference<T>::WindowStart(reference, windowSize);
+	int historyLength = reference.size() - referenceStart;
+	copy(reference.begin() + referenceStart, reference.end(), symbols);
+	vector<T>().swap(reference);
+
+	bool inputEnd = false;
+
+	//input that is not split has one block for its checksums
+	if (checksums && blockSymbols == 0)
+	{
+		StartBlock(inputStream);
+	}
+
+	while (!inputEnd)
+	{
+		if (blockSymbols > 0 && symbolsProcessed >= nextBlockStart)
+		{
+			StartBlock(inputStream);
+			historyLength = 0;
+		}
+
+		//fill the block behind the history, it doesn't reach into the next independent block
+		T * block = this->symbols + historyLength;
+		int blockLength = 0;
+		int wantedLength = (blockSymbols > 0 && nextBlockStart - symbolsProcessed < windowSize) ? nextBlockStart - symbolsProcessed : windowSize;
+		if (inputStream == NULL && longRangeMatcher == NULL)
+		{
+			//raw symbols - the whole block at once
+			int symbolsRead;
+			while (blockLength < wantedLength && (symbolsRead = inStream.ReadSymbols(block + blockLength, wantedLength - blockLength)) > 0)
+			{
+				blockLength += symbolsRead;
+			}
+		}
+		else
+		{
+			while (blockLength < wantedLength && ReadToken(inputStream, block[blockLength]))
+			{
+				blockLength++;
+			}
+		}
+
+		if (blockLength < wantedLength)
+		{
+			inputEnd = true;
+		}
+
+		if (blockLength == 0)
+			break;
+
+		if (checksums)
+		{
+			contentChecksum.UpdateSymbols(block, blockLength);
+		}
+
+		//stored block does not become history (the decoder doesn't keep it either), the time budget stores it without search
+		int historyPart = blockLength;
+		if (strategy == StoredStrategy)
+		{
+			historyPart = WriteStoredBlock(block, blockLength);
+			blockStrategies.Add(StoredStrategy);
+		}
+		else
+		{
+			MatchFinder<T> * finder = (strategy == FastStrategy) ? fastMatchFinder : matchFinder;
+			finder->FindMatches(symbols, historyLength, historyLength + blockLength, matchLengths, matchDistances);
+			if (ParseBlock(block, blockLength))
+			{
+				blockStrategies.Add(strategy);
+			}
+			else
+			{
+				historyPart = WriteStoredBlock(block, blockLength);
+				blockStrategies.Add(StoredStrategy);
+			}
+		}
+
+		//the last window becomes history of the next block
+		if (historyPart > 0)
+		{
+			int totalLength = historyLength + historyPart;
+			historyLength = (totalLength < windowSize) ? totalLength : windowSize;
+			memmove(symbols, symbols + totalLength - historyLength, historyLength * sizeof(T));
+		}
+		symbolsProcessed += blockLength;
+
+		//the budget is checked after every block - first the matcher gets faster, then the rest is stored
+		if (budget != NULL && strategy != StoredStrategy && !inputEnd && budget->IsAtRisk(symbolsProcessed))
+		{
+			if (strategy == LevelStrategy)
+			{
+				strategy = FastStrategy;
+				parsing = GreedyParsing;
+				fastMatchFinder = new HashChainMatchFinder<T>(2 * windowSize, FastChainDepth, escapeLength, false);
+			}
+			else if (storedBlocks)
+			{
+				strategy = StoredStrategy;
+			}
+
+			cout << endl << "\tTime budget at risk after " << fixed << setprecision(2) << budget->GetElapsedSeconds() << " s - blocks from symbol " << symbolsProcessed << " are " << (strategy == StoredStrategy ? "stored" : "compressed by fast hash chains") << endl;
+			budget->Switched(symbolsProcessed);
+		}
+
+		if (showProgress)
+		{
+			donePart = (double)symbolsProcessed / inputFileSize;
+			dashesCount = donePart / 0.04;
+			cout << "\r\t";
+			for (short i = 0; i < dashesCount; i++)
+			{
+				cout << "-";
+			}
+			cout << fixed << " " << donePart * 100 << " %";
+		}
+	}
+
+	outputBytesHelper->FinishWork(encoder.EncodeMatch(Match(outputBytesHelper->GetRemainingFlagsCount(), 0)));
+	delete (budget);
+
+	if (blockIndex.GetCount() > 0)
+	{
+		if (checksums)
+		{
+			blockIndex.SetLastChecksums(outStream.TakeChecksum(), contentChecksum.GetValue());
+		}
+
+		vector<uchar> indexBytes;
+		blockIndex.Encode(indexBytes);
+		for (uchar indexByte : indexBytes)
+		{
+			outStream.WriteByte(indexByte);
+		}
+	}
+
+	inStream.Close();
+	outStream.Close();
+}
+
+template <typename T>
+void BlockCompressor<T>::Decompress(long long inputFileSize, bool showProgress, TokenOutputStream * outputStream)
+{
+	this->decompressor->Decompress(inputFileSize, showProgress, outputStream);
+}
+
+template <typename T>
+void BlockCompressor<T>::WriteCompressionStatistics()
+{
+	cout << "======================================================================================" << endl;
+	cout << "Bytes written / read: " << outStream.GetBytesWritten() << " / " << inStream.GetBytesRead() << endl;
+	cout << "Compression ratio: " << (double)outStream.GetBytesWritten() / inStream.GetBytesRead() * 100 << " (" << (double)(outStream.GetBytesWritten() * 8) / inStream.GetBytesRead() << " bpB)" << endl;
+	if (showStrategies)
+	{
+		cout << "Blocks - level: " << blockStrategies.GetCount(LevelStrategy) << ", fast: " << blockStrategies.GetCount(FastStrategy) << ", stored: " << blockStrategies.GetCount(StoredStrategy) << endl;
+		blockStrategies.Write("Blocks", "level");
+	}
+	cout << "======================================================================================" << endl;
+}
+
+template <typename T>
+void BlockCompressor<T>::WriteDecompressionStatistics()
+{
+	this->decompressor->WriteDecompressionStatistics();
+}
+
+template <typename T>
+inline bool BlockCompressor<T>::ReadToken(TokenInputStream * inputStream, T & token)
+{
+	if (longRangeMatcher != NULL)
+		return longRangeMatcher->ReadToken(token);
+
+	int tokenId;
+	if ((tokenId = inputStream->ReadToken()) == -1)
+		return false;
+
+	token = tokenId;
+	return true;
+}
+
+template <typename T>
+bool BlockCompressor<T>::ParseBlock(T * block, int blockLength)
+{
+	//the long-range match from the previous block may cover beginning of this one
+	long long previousMatchEnd = longRangeMatchEnd;
+	int firstPosition = (longRangeMatchEnd - symbolsProcessed < blockLength) ? (int)(longRangeMatchEnd - symbolsProcessed) : blockLength;
+	if (firstPosition < 0) firstPosition = 0;
+
+	//entropy coding makes literals and match codes smaller, stored symbols stay raw
+	short literalBits = entropyCoding ? StoredBlock<T>::EntropyCodedLiteralBits(block + firstPosition, blockLength - firstPosition) : 0;
+
+	long long bits = 0;
+	blockLongRangeMatches.clear();
+	for (int start = firstPosition; start < blockLength; )
+	{
+		long long nextPosition = (longRangeMatcher != NULL) ? longRangeMatcher->NextMatchPosition() : LLONG_MAX;
+		int end = (nextPosition - symbolsProcessed < blockLength) ? (int)(nextPosition - symbolsProcessed) : blockLength;
+
+		long long rangeBits = (parsing == OptimalParsing) ? ParseRangeOptimal(block, start, end) : ParseRange(block, start, end);
+		bits += entropyCoding ? EntropyCodedBits(start, end, literalBits) : rangeBits;
+
+		if (end == blockLength)
+			break;
+
+		LongRangeMatch longRangeMatch = longRangeMatcher->TakeMatch();
+		blockLongRangeMatches.push_back(longRangeMatch);
+		parseLengths[end] = LongRangeItem;
+		bits += MatchCost(1) + 8 * LongRangeMatcher<T>::ExtraBytesCount;
+
+		longRangeMatchEnd = longRangeMatch.Position + longRangeMatch.Length;
+		start = (longRangeMatchEnd - symbolsProcessed < blockLength) ? (int)(longRangeMatchEnd - symbolsProcessed) : blockLength;
+	}
+
+	//expansion is decided by the encoded size - literals cost more than stored symbols, so it depends on coverage by matches
+	long long storedBits = MatchCost(1) + 8 * StoredBlock<T>::ExtraBytesCount + 8 * sizeof(T) * (long long)(blockLength - firstPosition);
+	if (storedBlocks && bits > storedBits)
+	{
+		//the stored block skips long-range matches that start in it
+		longRangeMatchEnd = previousMatchEnd;
+		return false;
+	}
+
+	WriteParsedBlock(block, firstPosition, blockLength);
+	return true;
+}
+
+template <typename T>
+void BlockCompressor<T>::WriteParsedBlock(T * block, int start, int blockLength)
+{
+	size_t longRangeIndex = 0;
+	for (int i = start; i < blockLength; )
+	{
+		if (parseLengths[i] == LongRangeItem)
+		{
+			LongRangeMatch longRangeMatch = blockLongRangeMatches[longRangeIndex++];
+			LongRangeMatcher<T>::EncodeExtraBytes(longRangeMatch, longRangeBytes);
+			outputBytesHelper->AppendMatch(encoder.EncodeMatch(Match(LongRangeMatcher<T>::MarkerIndex, 0)), longRangeBytes, LongRangeMatcher<T>::ExtraBytesCount);
+
+			long long matchEnd = longRangeMatch.Position + longRangeMatch.Length;
+			i = (matchEnd - symbolsProcessed < blockLength) ? (int)(matchEnd - symbolsProcessed) : blockLength;
+		}
+		else if (parseLengths[i] > 0)
+		{
+			WriteMatch(block, i, parseLengths[i]);
+			i += parseLengths[i];
+		}
+		else
+		{
+			outputBytesHelper->AppendSymbol(block[i]);
+			i++;
+		}
+	}
+}
+
+template <typename T>
+int BlockCompressor<T>::WriteStoredBlock(T * block, int blockLength)
+{
+	int start = (longRangeMatchEnd - symbolsProcessed < blockLength) ? (int)(longRangeMatchEnd - symbolsProcessed) : blockLength;
+	if (start < 0)
+	{
+		start = 0;
+	}
+
+	if (start < blockLength)
+	{
+		uchar lengthBytes[StoredBlock<T>::ExtraBytesCount];
+		StoredBlock<T>::EncodeLength(blockLength - start, lengthBytes);
+		outputBytesHelper->AppendStoredBlock(encoder.EncodeMatch(Match(StoredBlock<T>::MarkerIndex, 0)), lengthBytes, StoredBlock<T>::ExtraBytesCount, block + start, blockLength - start);
+	}
+
+	//long-range matches inside the block are not written
+	if (longRangeMatcher != NULL)
+	{
+		longRangeMatcher->SkipMatches(symbolsProcessed + blockLength);
+	}
+
+	//symbols of the long-range match enter the decoder window
+	return start;
+}
+
+template <typename T>
+long long BlockCompressor<T>::ParseRange(T * block, int start, int end)
+{
+	long long bits = 0;
+	for (int i = start; i < end; )
+	{
+		int matchLength = ExtendMatch(block, i, end);
+
+		//one-step lookahead - if the next symbol starts longer match, output this one as literal
+		if (parsing == LazyParsing && i + 1 < end && matchLength < matchLengthMaxValue && matchLengths[i + 1] > matchLength)
+		{
+			matchLength = 0;
+		}
+
+		//reference is useful only if it is longer than the match bytes
+		if (matchLength > matchBytesCount)
+		{
+			parseLengths[i] = matchLength;
+			bits += MatchCost(matchLength);
+			i += matchLength;
+		}
+		else
+		{
+			parseLengths[i] = 0;
+			bits += LiteralCost();
+			i++;
+		}
+	}
+
+	return bits;
+}
+
+template <typename T>
+long long BlockCompressor<T>::EntropyCodedBits(int start, int end, short literalBits)
+{
+	long long bits = 0;
+	for (int i = start; i < end; )
+	{
+		if (parseLengths[i] > 0)
+		{
+			long long literalsBits = (1 + literalBits) * (long long)parseLengths[i];
+			bits += min(MatchCost(parseLengths[i]), literalsBits);
+			i += parseLengths[i];
+		}
+		else
+		{
+			bits += 1 + literalBits;
+			i++;
+		}
+	}
+
+	return bits;
+}
+
+template <typename T>
+long long BlockCompressor<T>::ParseRangeOptimal(T * block, int start, int end)
+{
+	long long literalCost = LiteralCost();
+	long long matchCost = MatchCost(1);
+
+	//shortest path from every position to the end of the part
+	parseCosts[end] = 0;
+	int nextLongestMatch = 0;
+	int cheapestCount = 0;
+	for (int i = end - 1; i >= start; i--)
+	{
+		//positions farther than a cheaper one are never the cheapest end of short match, the farthest is at the bottom
+		while (cheapestCount > 0 && parseCosts[cheapestPositions[cheapestCount - 1]] >= parseCosts[i + 1])
+		{
+			cheapestCount--;
+		}
+		cheapestPositions[cheapestCount++] = i + 1;
+
+		parseCosts[i] = literalCost + parseCosts[i + 1];
+		parseLengths[i] = 0;
+
+		//in long repeat the match of the next position from the same distance is one symbol shorter
+		int longestMatch;
+		if (matchLengths[i] >= escapeLength && nextLongestMatch >= escapeLength && matchDistances[i] == matchDistances[i + 1])
+			longestMatch = (nextLongestMatch < matchLengthMaxValue) ? nextLongestMatch + 1 : matchLengthMaxValue;
+		else
+			longestMatch = ExtendMatch(block, i, end);
+		nextLongestMatch = longestMatch;
+
+		//lengths that fit into length field cost the same - the shortest one that reaches the cheapest position is taken,
+		//only the longest one is tried with extension
+		int shortLength = (longestMatch < escapeLength) ? longestMatch : escapeLength - 1;
+		if (shortLength > 0)
+		{
+			int low = 0;
+			int high = cheapestCount - 1;
+			while (low < high)
+			{
+				int middle = (low + high) / 2;
+				if (cheapestPositions[middle] <= i + shortLength)
+					high = middle;
+				else
+					low = middle + 1;
+			}
+
+			int cheapestPosition = cheapestPositions[low];
+			if (matchCost + parseCosts[cheapestPosition] < parseCosts[i])
+			{
+				parseCosts[i] = matchCost + parseCosts[cheapestPosition];
+				parseLengths[i] = cheapestPosition - i;
+			}
+		}
+
+		if (longestMatch >= escapeLength && MatchCost(longestMatch) + parseCosts[i + longestMatch] < parseCosts[i])
+		{
+			parseCosts[i] = MatchCost(longestMatch) + parseCosts[i + longestMatch];
+			parseLengths[i] = longestMatch;
+		}
+	}
+
+	return parseCosts[start];
+}
+
+template <typename T>
+void BlockCompressor<T>::WriteMatch(T * block, int position, int matchLength)
+{
+	//index is relative to the front of buffer, which is twice the window size
+	int matchIndex = PreferRepeatOffset(block, position, matchLength, (-matchDistances[position]) & (2 * windowSize - 1));
+
+	uchar extensionBytes[Encoder::MaxExtensionBytes];
+	short extensionBytesCount = Encoder::EncodeLengthExtension(matchLength, matchLengthSizeBits, extensionBytes);
+	short repeatSlot = encoder.UpdateRepeatOffsets(matchIndex);
+	unsigned long long matchCode = encoder.EncodeMatch(Match(matchIndex, matchLength));
+	if (repeatSlot >= 0)
+		outputBytesHelper->AppendMatch(encoder.EncodeRepeatMatch(repeatSlot, matchLength), encoder.GetRepeatMatchBits(), extensionBytes, extensionBytesCount);
+	else if (extensionBytesCount > 0)
+		outputBytesHelper->AppendMatch(matchCode, extensionBytes, extensionBytesCount);
+	else
+		outputBytesHelper->AppendMatch(matchCode);
+}
+
+template <typename T>
+int BlockCompressor<T>::PreferRepeatOffset(T * block, int position, int matchLength, int matchIndex)
+{
+	for (short slot = 0; slot < RepeatOffsets::Count; slot++)
+	{
+		if (encoder.GetRepeatOffset(slot) == matchIndex)
+			return matchIndex;
+	}
+
+	int historyLength = block - symbols;
+	for (short slot = 0; slot < RepeatOffsets::Count; slot++)
+	{
+		//empty slot, or the candidate starts in front of the history
+		int index = encoder.GetRepeatOffset(slot);
+		int distance = (-index) & (2 * windowSize - 1);
+		if (index == 0 || distance > historyLength + position)
+			continue;
+
+		const T * source = block + position - distance;
+		int length = 0;
+		while (length < matchLength && source[length] == block[position + length])
+		{
+			length++;
+		}
+
+		if (length == matchLength)
+			return index;
+	}
+
+	return matchIndex;
+}
+
+template <typename T>
+int BlockCompressor<T>::ExtendMatch(T * block, int position, int end)
+{
+	int maxLength = (end - position < matchLengthMaxValue) ? end - position : matchLengthMaxValue;
+	int matchLength = (matchLengths[position] < maxLength) ? matchLengths[position] : maxLength;
+
+	//source may overlap the match - symbols are compared in the order the decoder copies them
+	if (matchLength >= escapeLength)
+	{
+		const T * source = block + position - matchDistances[position];
+		while (matchLength < maxLength && source[matchLength] == block[position + matchLength])
+		{
+			matchLength++;
+		}
+	}
+
+	return matchLength;
+}
+
+template <typename T>
+long long BlockCompressor<T>::MatchCost(int matchLength)
+{
+	uchar extensionBytes[Encoder::MaxExtensionBytes];
+	return (sequences ? OutputBytesHelper<T>::LiteralRunBits : 1) + encoder.GetMatchBits() + 8 * Encoder::EncodeLengthExtension(matchLength, matchLengthSizeBits, extensionBytes);
+}
+
+template <typename T>
+long long BlockCompressor<T>::LiteralCost()
+{
+	//every item costs one flag bit besides its bits, sequence layout has literals without flags
+	return (sequences ? 0 : 1) + 8 * sizeof(T);
+}
+
+template <typename T>
+void BlockCompressor<T>::StartBlock(TokenInputStream * inputStream)
+{
+	//the block ends the same way as the whole output
+	if (symbolsProcessed > 0)
+	{
+		outputBytesHelper->EndBlock(encoder.EncodeMatch(Match(outputBytesHelper->GetRemainingFlagsCount(), 0)));
+		encoder.ResetRepeatOffsets();
+	}
+
+	//the ended block gets its checksums, data in front of the first block are not covered
+	if (checksums)
+	{
+		if (blockIndex.GetCount() > 0)
+			blockIndex.SetLastChecksums(outStream.TakeChecksum(), contentChecksum.GetValue());
+		else
+			outStream.StartChecksum();
+
+		contentChecksum.Reset();
+	}
+
+	BlockIndexEntry entry;
+	entry.CompressedOffset = outStream.GetBytesWritten();
+	entry.SymbolOffset = symbolsProcessed;
+	entry.ByteOffset = (inputStream != NULL) ? inputStream->tokenBytesRead : symbolsProcessed * sizeof(T);
+	entry.CompressedChecksum = entry.ContentChecksum = 0;
+	blockIndex.Add(entry);
+
+	nextBlockStart = symbolsProcessed + blockSymbols;
+}
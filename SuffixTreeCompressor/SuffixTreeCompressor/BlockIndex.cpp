@@ -0,0 +1,179 @@
+#include "BlockIndex.h"
+#include "Crc32c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+BlockIndex::BlockIndex()
+{
+	this->checksums = false;
+	this->compressedEnd = 0;
+}
+
+void BlockIndex::SetChecksums(bool checksums)
+{
+	this->checksums = checksums;
+}
+
+void BlockIndex::Add(const BlockIndexEntry& entry)
+{
+	entries.push_back(entry);
+}
+
+void BlockIndex::SetLastChecksums(unsigned int compressedChecksum, unsigned int contentChecksum)
+{
+	entries.back().CompressedChecksum = compressedChecksum;
+	entries.back().ContentChecksum = contentChecksum;
+}
+
+void BlockIndex::Encode(vector<uchar>& bytes) const
+{
+	for (const BlockIndexEntry& entry : entries)
+	{
+		long long values[3] = { entry.CompressedOffset, entry.SymbolOffset, entry.ByteOffset };
+		for (short i = 0; i < 3; i++)
+		{
+			for (short j = 7; j >= 0; j--)
+			{
+				bytes.push_back((values[i] >> (j * 8)) & 0xff);
+			}
+		}
+
+		if (checksums)
+		{
+			unsigned int entryChecksums[2] = { entry.CompressedChecksum, entry.ContentChecksum };
+			for (short i = 0; i < 2; i++)
+			{
+				for (short j = 3; j >= 0; j--)
+				{
+					bytes.push_back((entryChecksums[i] >> (j * 8)) & 0xff);
+				}
+			}
+		}
+	}
+
+	int count = entries.size();
+	for (short j = 3; j >= 0; j--)
+	{
+		bytes.push_back((count >> (j * 8)) & 0xff);
+	}
+
+	for (short j = 0; j < 4; j++)
+	{
+		bytes.push_back((Magic >> (j * 8)) & 0xff);
+	}
+}
+
+void BlockIndex::Read(const string& fileName)
+{
+	ifstream input(fileName, ios::in | ios::binary | ios::ate);
+	long long fileSize = (long long)input.tellg();
+	input.close();
+
+	Read(fileName, 0, fileSize);
+}
+
+void BlockIndex::Read(const string& fileName, long long frameStart, long long frameEnd)
+{
+	ifstream input(fileName, ios::in | ios::binary);
+	long long frameSize = frameEnd - frameStart;
+
+	uchar trailer[TrailerSize];
+	input.seekg(frameEnd - TrailerSize);
+	input.read(reinterpret_cast<char *>(trailer), TrailerSize);
+
+	int count = 0;
+	unsigned int magic = 0;
+	for (short j = 0; j < 4; j++)
+	{
+		count = (count << 8) | trailer[j];
+		magic |= (unsigned int)trailer[4 + j] << (j * 8);
+	}
+
+	int entrySize = GetEntrySize();
+	if (frameSize < TrailerSize || input.fail() || magic != Magic || count <= 0 || (long long)count * entrySize > frameSize - TrailerSize)
+	{
+		fprintf(stderr, "FATAL:\t\"%s\" has no block index\n", fileName.c_str());
+		exit(1);
+	}
+
+	compressedEnd = frameEnd - TrailerSize - (long long)count * entrySize;
+	vector<uchar> bytes((size_t)count * entrySize);
+	input.seekg(compressedEnd);
+	input.read(reinterpret_cast<char *>(bytes.data()), bytes.size());
+
+	entries.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		long long values[3] = { 0, 0, 0 };
+		for (short j = 0; j < 3; j++)
+		{
+			for (short k = 0; k < 8; k++)
+			{
+				values[j] = (values[j] << 8) | bytes[i * entrySize + j * 8 + k];
+			}
+		}
+
+		entries[i].CompressedOffset = frameStart + values[0];
+		entries[i].SymbolOffset = values[1];
+		entries[i].ByteOffset = values[2];
+
+		unsigned int entryChecksums[2] = { 0, 0 };
+		for (short j = 0; checksums && j < 2; j++)
+		{
+			for (short k = 0; k < 4; k++)
+			{
+				entryChecksums[j] = (entryChecksums[j] << 8) | bytes[i * entrySize + EntrySize + j * 4 + k];
+			}
+		}
+
+		entries[i].CompressedChecksum = entryChecksums[0];
+		entries[i].ContentChecksum = entryChecksums[1];
+	}
+}
+
+int BlockIndex::FindBlock(long long byteOffset) const
+{
+	//the last block that starts at the byte or before it
+	int low = 0;
+	int high = entries.size() - 1;
+	while (low < high)
+	{
+		int middle = (low + high + 1) / 2;
+		if (entries[middle].ByteOffset <= byteOffset)
+			low = middle;
+		else
+			high = middle - 1;
+	}
+
+	return low;
+}
+
+long long BlockIndex::GetCompressedEnd(int block) const
+{
+	return (block + 1 < (int)entries.size()) ? entries[block + 1].CompressedOffset : compressedEnd;
+}
+
+bool BlockIndex::CheckCompressedBlock(ifstream & input, int block) const
+{
+	long long start = entries[block].CompressedOffset;
+	long long end = GetCompressedEnd(block);
+	if (start > end)
+		return false;
+
+	Crc32c checksum;
+	vector<uchar> part(CheckedPartSize);
+	input.clear();
+	input.seekg(start);
+	for (long long position = start; position < end; position += CheckedPartSize)
+	{
+		int partSize = (int)min((long long)CheckedPartSize, end - position);
+		input.read(reinterpret_cast<char *>(part.data()), partSize);
+		if (input.gcount() != partSize)
+			return false;
+
+		checksum.Update(part.data(), partSize);
+	}
+
+	return checksum.GetValue() == entries[block].CompressedChecksum;
+}
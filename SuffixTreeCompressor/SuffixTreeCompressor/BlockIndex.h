@@ -0,0 +1,163 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+
+using namespace std;
+
+typedef unsigned char uchar;
+
+/**
+ * <summary> A struct to save where one independent block starts.</summary>
+ */
+
+struct BlockIndexEntry
+{
+	public:
+		long long CompressedOffset;		///< Position of the first byte of the block in the compressed file
+		long long SymbolOffset;			///< Number of symbols (tokens or bytes) before the block
+		long long ByteOffset;			///< Number of bytes of the input before the block
+		unsigned int CompressedChecksum;	///< CRC32C of the compressed data of the block
+		unsigned int ContentChecksum;		///< CRC32C of the symbols of the block (bytes of every symbol from the lowest one)
+};
+
+/**
+ * <summary> Index of independent blocks written behind the compressed data. Every block starts with empty window and ends
+ *  with its own end mark, so it can be decoded alone. The index is followed by number of blocks and Magic. Entries of file
+ *  with checksums hold also CRC32C of the compressed data and of the decoded symbols of the block.</summary>
+ */
+
+class BlockIndex
+{
+	public:
+		static const unsigned int Magic = 0x49435453;	///< "STCI" - the last bytes of file with index
+		static const int EntrySize = 24;				///< Number of bytes of one entry
+		static const int TrailerSize = 8;				///< Number of bytes behind the entries - count of blocks and magic
+		static const int ChecksumsSize = 8;				///< Number of bytes of checksums of one entry
+
+		BlockIndex();
+
+		/**
+		 * <summary> Sets whether entries hold checksums (before Read or Encode).</summary>
+		 *
+		 * <param name="checksums"> True if entries hold checksums.</param>
+		 */
+
+		void SetChecksums(bool checksums);
+
+		/**
+		 * <summary> Adds block to the index.</summary>
+		 *
+		 * <param name="entry"> Offsets of the block.</param>
+		 */
+
+		void Add(const BlockIndexEntry& entry);
+
+		/**
+		 * <summary> Sets checksums of the last block of the index.</summary>
+		 *
+		 * <param name="compressedChecksum"> CRC32C of the compressed data.</param>
+		 * <param name="contentChecksum">	   CRC32C of the symbols.</param>
+		 */
+
+		void SetLastChecksums(unsigned int compressedChecksum, unsigned int contentChecksum);
+
+		/**
+		 * <summary> Encodes the index with its trailer.</summary>
+		 *
+		 * <param name="bytes"> The bytes.</param>
+		 */
+
+		void Encode(vector<uchar>& bytes) const;
+
+		/**
+		 * <summary> Reads the index from the end of compressed file - it is fatal if the file has no index.</summary>
+		 *
+		 * <param name="fileName"> Filename of the compressed file.</param>
+		 */
+
+		void Read(const string& fileName);
+
+		/**
+		 * <summary> Reads the index from the end of frame of archive - offsets of blocks are moved to positions in the
+		 *  archive.</summary>
+		 *
+		 * <param name="fileName">   Filename of the archive.</param>
+		 * <param name="frameStart"> Position of the first byte of the frame.</param>
+		 * <param name="frameEnd">	 Position behind the last byte of the frame.</param>
+		 */
+
+		void Read(const string& fileName, long long frameStart, long long frameEnd);
+
+		/**
+		 * <summary> Finds block that contains the byte of the input.</summary>
+		 *
+		 * <param name="byteOffset"> Position of the byte.</param>
+		 *
+		 * <returns> Index of the block.</returns>
+		 */
+
+		int FindBlock(long long byteOffset) const;
+
+		/**
+		 * <summary> Gets position behind the last byte of compressed data of block (the index follows the last block).</summary>
+		 *
+		 * <param name="block"> Index of the block.</param>
+		 *
+		 * <returns> The position.</returns>
+		 */
+
+		long long GetCompressedEnd(int block) const;
+
+		/**
+		 * <summary> Checks compressed data of block against its checksum - they are read in parts, so the block can be of
+		 *  any size.</summary>
+		 *
+		 * <param name="input"> The compressed file.</param>
+		 * <param name="block"> Index of the block.</param>
+		 *
+		 * <returns> True if the data are intact.</returns>
+		 */
+
+		bool CheckCompressedBlock(ifstream & input, int block) const;
+
+		int GetCount() const;
+		const BlockIndexEntry& Get(int block) const;
+		bool HasChecksums() const;
+
+	private:
+		static const int CheckedPartSize = 1 << 20;	///< Number of bytes of compressed data that are checksummed at once
+
+		vector<BlockIndexEntry> entries;	///< Blocks ordered by position
+		bool checksums;						///< Whether entries hold checksums
+		long long compressedEnd;			///< Position of the first byte of the index (known after Read)
+
+		/**
+		 * <summary> Gets number of bytes of one entry.</summary>
+		 *
+		 * <returns> The entry size.</returns>
+		 */
+
+		int GetEntrySize() const;
+};
+
+
+inline int BlockIndex::GetCount() const
+{
+	return entries.size();
+}
+
+inline const BlockIndexEntry& BlockIndex::Get(int block) const
+{
+	return entries[block];
+}
+
+inline bool BlockIndex::HasChecksums() const
+{
+	return checksums;
+}
+
+inline int BlockIndex::GetEntrySize() const
+{
+	return EntrySize + (checksums ? ChecksumsSize : 0);
+}
@@ -1,14 +1,16 @@
 #pragma once
+#include "HugePageAllocator.h"
 
 /**
- * <summary> A class to encapsulate handling with buffer itself.</summary>
+ * <summary> A class to encapsulate handling with buffer itself. If WindowBits is nonzero, the window size is fixed
+ *  at compile time and the index masks are constants; zero means the size is given at run time.</summary>
  */
 
 typedef unsigned char uchar;
 
 //Declaration----------------------------------------------------------------------------------------------------------------------------------------------------------
 
-template <typename T>
+template <typename T, int WindowBits = 0>
 class Buffer
 {
 	public:
@@ -56,6 +58,12 @@ class Buffer
 
 		bool SlidingWindowIsEmptyWhileDecoding();
 
+		/**
+		 * <summary> Empties the sliding window - symbols before are not used any more (start of independent block).</summary>
+		 */
+
+		void Reset();
+
 		/**
 		 * <summary> Gets symbol from buffer.</summary>
 		 *
@@ -85,6 +93,17 @@ class Buffer
 
 		bool IsOffsetHigher(int off1, int off2);
 
+		/**
+		 * <summary> Check if 'off1' points to newer symbol than 'off2' - it is closer behind the front.</summary>
+		 *
+		 * <param name="off1"> The first offset.</param>
+		 * <param name="off2"> The second offset.</param>
+		 *
+		 * <returns> True if offset1 is newer, false if not.</returns>
+		 */
+
+		bool IsOffsetNewer(int off1, int off2);
+
 		/**
 		 * <summary> Gets the last symbol while decoding.</summary>
 		 *
@@ -95,9 +114,11 @@ class Buffer
 
 		/**
 		 * <summary> Appends the match symbol into sliding window.</summary>
+		 *
+		 * <returns> The appended symbol.</returns>
 		 */
 
-		void AppendMatchSymbol();
+		T AppendMatchSymbol();
 
 		/**
 		 * <summary> Sets index, where match starts - for no more need to ask for it.</summary>
@@ -122,10 +143,19 @@ class Buffer
 		bool FrontIsOnEdge();
 
 	private:
+		/**
+		* <summary> Gets mask for wrapping indices around the buffer.</summary>
+		*
+		* <returns> The mask.</returns>
+		*/
+
+		int Mask();
+
 		T * buffer;				///< The buffer itself
 		int front;					///< The front of sliding window - index of next symbol placing
 		int back;					///< The back of sliding window - index of next symbol deleting
 		short bufferSizeBits;		///< The size of sliding window in bits
+		int bufferMask;				///< Mask for wrapping indices around the buffer (used if WindowBits is zero)
 		int slidingWindowLength;	///< Length of the sliding window
 		int bufferLength;			///< The length of the buffer
 		int bufferHalfLength;		///< Half length of the buffer (used for checking if front is on updating point)
@@ -134,70 +164,78 @@ class Buffer
 
 //Definition----------------------------------------------------------------------------------------------------------------------------------------------------------
 
-template <typename T> 
-Buffer<T>::Buffer(short windowSizeBits)
+template <typename T, int WindowBits>
+Buffer<T, WindowBits>::Buffer(short windowSizeBits)
 {
 	this->front = 0;
 	this->back = 0;
 	this->slidingWindowLength = 1 << windowSizeBits;
 	this->bufferSizeBits = windowSizeBits + 1;
+	this->bufferMask = (1 << bufferSizeBits) - 1;
 	this->bufferHalfLength = slidingWindowLength;
-	this->buffer = new T[1 << bufferSizeBits];
+	this->buffer = HugePageAllocator::NewArray<T>(1 << bufferSizeBits);
+}
+
+template <typename T, int WindowBits>
+Buffer<T, WindowBits>::~Buffer()
+{
+	HugePageAllocator::DeleteArray(buffer, 1 << bufferSizeBits);
 }
 
-template <typename T> 
-Buffer<T>::~Buffer()
+template <typename T, int WindowBits>
+void Buffer<T, WindowBits>::Reset()
 {
-	delete[] buffer;
+	this->front = 0;
+	this->back = 0;
 }
 
-template <typename T> 
-int Buffer<T>::GetSlidingWindowFront()
+template <typename T, int WindowBits>
+int Buffer<T, WindowBits>::GetSlidingWindowFront()
 {
 	return this->front;
 }
 
-template <typename T> 
-int Buffer<T>::GetSlidingWindowBack()
+template <typename T, int WindowBits>
+int Buffer<T, WindowBits>::GetSlidingWindowBack()
 {
 	return this->back;
 }
 
-template <typename T> 
-int Buffer<T>::GetSlidingWindowLength()
+template <typename T, int WindowBits>
+int Buffer<T, WindowBits>::GetSlidingWindowLength()
 {
 	return this->slidingWindowLength;
 }
 
-template <typename T> 
-bool Buffer<T>::SlidingWindowIsFull()
+template <typename T, int WindowBits>
+bool Buffer<T, WindowBits>::SlidingWindowIsFull()
 {
 	return abs(this->front - this->back) >= this->slidingWindowLength;
 }
 
-template <typename T> 
-bool Buffer<T>::SlidingWindowIsEmptyWhileDecoding()
+template <typename T, int WindowBits>
+bool Buffer<T, WindowBits>::SlidingWindowIsEmptyWhileDecoding()
 {
 	return this->back == this->front;
 }
 
-template <typename T> 
-T Buffer<T>::GetSymbolFromBuffer(int index)
+template <typename T, int WindowBits>
+T Buffer<T, WindowBits>::GetSymbolFromBuffer(int index)
 {
-	return this->buffer[index & ((1 << bufferSizeBits) - 1)];
+	return this->buffer[index & Mask()];
 }
 
-template <typename T> 
-void Buffer<T>::AppendSymbolToSlidingWindow(T symbol)
+template <typename T, int WindowBits>
+void Buffer<T, WindowBits>::AppendSymbolToSlidingWindow(T symbol)
 {
 	this->buffer[this->front] = symbol;
 
 	this->front++;
-	this->front &= ((1 << bufferSizeBits) - 1);
+	this->front &= Mask();
 }
 
-template <typename T> 
-bool Buffer<T>::IsOffsetHigher(int off1, int off2)
+template <typename T, int WindowBits>
+bool Buffer<T, WindowBits>::IsOffsetHigher(int off1, int off2)
 {
 	if (front > back && off2 > off1)
 	{
@@ -217,38 +255,56 @@ bool Buffer<T>::IsOffsetHigher(int off1, int off2)
 	return false;
 }
 
-template <typename T> 
-T Buffer<T>::GetLastSymbol()
+template <typename T, int WindowBits>
+bool Buffer<T, WindowBits>::IsOffsetNewer(int off1, int off2)
+{
+	int mask = Mask();
+
+	//compare distances behind the front - it works even if the sliding window crosses the end of buffer
+	return ((this->front - off1) & mask) < ((this->front - off2) & mask);
+}
+
+template <typename T, int WindowBits>
+T Buffer<T, WindowBits>::GetLastSymbol()
 {
 	T symbol = this->buffer[this->back];
 
 	this->back++;
-	this->back &= ((1 << bufferSizeBits) - 1);
+	this->back &= Mask();
 
 	return symbol;
 }
 
-template <typename T> 
-void Buffer<T>::AppendMatchSymbol()
+template <typename T, int WindowBits>
+T Buffer<T, WindowBits>::AppendMatchSymbol()
 {
-	AppendSymbolToSlidingWindow(this->buffer[(this->front + matchIndex) & ((1 << bufferSizeBits) - 1)]);
+	T symbol = this->buffer[(this->front + matchIndex) & Mask()];
+	AppendSymbolToSlidingWindow(symbol);
+
+	return symbol;
 }
 
-template <typename T> 
-void Buffer<T>::SetMatchIndex(int matchIndex)
+template <typename T, int WindowBits>
+void Buffer<T, WindowBits>::SetMatchIndex(int matchIndex)
 {
 	this->matchIndex = matchIndex;
 }
 
-template <typename T> 
-void Buffer<T>::MoveBackForward()
+template <typename T, int WindowBits>
+void Buffer<T, WindowBits>::MoveBackForward()
 {
 	this->back++;
-	this->back &= ((1 << bufferSizeBits) - 1);
+	this->back &= Mask();
 }
 
-template <typename T>
-bool Buffer<T>::FrontIsOnEdge()
+template <typename T, int WindowBits>
+bool Buffer<T, WindowBits>::FrontIsOnEdge()
 {
 	return this->front == 0 || this->front == this->bufferHalfLength;
+}
+
+template <typename T, int WindowBits>
+inline int Buffer<T, WindowBits>::Mask()
+{
+	return (WindowBits > 0) ? (2 << WindowBits) - 1 : this->bufferMask;
 }
\ No newline at end of file
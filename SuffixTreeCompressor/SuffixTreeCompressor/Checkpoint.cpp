@@ -0,0 +1,171 @@
+#include "Checkpoint.h"
+#include <fstream>
+#include <stdio.h>
+#include <stdlib.h>
+
+Checkpoint::Checkpoint(bool binary)
+{
+	this->binary = binary;
+	this->inputBytes = 0;
+}
+
+void Checkpoint::Load(const string& fileName)
+{
+	ifstream input(fileName, ios::in | ios::binary);
+	if (input.fail())
+	{
+		fprintf(stderr, "FATAL:\tCan't open checkpoint \"%s\"\n", fileName.c_str());
+		exit(1);
+	}
+
+	uchar header[HeaderSize];
+	input.read(reinterpret_cast<char *>(header), HeaderSize);
+
+	unsigned int magic = 0;
+	for (short j = 0; j < 4; j++)
+	{
+		magic |= (unsigned int)header[j] << (j * 8);
+	}
+
+	bool savedBinary = header[4] != 0;
+
+	unsigned long long savedInputBytes = 0;
+	for (short j = 0; j < 8; j++)
+	{
+		savedInputBytes = (savedInputBytes << 8) | header[5 + j];
+	}
+	inputBytes = (long long)savedInputBytes;
+
+	int count = 0;
+	for (short j = 0; j < 4; j++)
+	{
+		count = (count << 8) | header[13 + j];
+	}
+
+	if (input.fail() || magic != Magic || count < 0)
+	{
+		fprintf(stderr, "FATAL:\t\"%s\" is not a checkpoint\n", fileName.c_str());
+		exit(1);
+	}
+
+	if (savedBinary != binary)
+	{
+		fprintf(stderr, "FATAL:\tCheckpoint \"%s\" was saved in %s mode\n", fileName.c_str(), savedBinary ? "byte" : "token");
+		exit(1);
+	}
+
+	vector<uchar> bytes((size_t)count * SymbolSize);
+	input.read(reinterpret_cast<char *>(bytes.data()), bytes.size());
+	if (input.fail())
+	{
+		fprintf(stderr, "FATAL:\tCheckpoint \"%s\" is truncated\n", fileName.c_str());
+		exit(1);
+	}
+	input.close();
+
+	symbols.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		unsigned int symbol = 0;
+		for (short j = 0; j < SymbolSize; j++)
+		{
+			symbol = (symbol << 8) | bytes[i * SymbolSize + j];
+		}
+		symbols[i] = (int)symbol;
+	}
+}
+
+void Checkpoint::Save(const string& fileName, const string& dictionaryFileName)
+{
+	vector<uchar> bytes;
+	bytes.reserve(HeaderSize + symbols.size() * SymbolSize);
+	for (short j = 0; j < 4; j++)
+	{
+		bytes.push_back((Magic >> (j * 8)) & 0xff);
+	}
+
+	bytes.push_back(binary ? 1 : 0);
+
+	for (short j = 7; j >= 0; j--)
+	{
+		bytes.push_back((inputBytes >> (j * 8)) & 0xff);
+	}
+
+	int count = symbols.size();
+	for (short j = 3; j >= 0; j--)
+	{
+		bytes.push_back((count >> (j * 8)) & 0xff);
+	}
+
+	for (int symbol : symbols)
+	{
+		for (short j = SymbolSize - 1; j >= 0; j--)
+		{
+			bytes.push_back((symbol >> (j * 8)) & 0xff);
+		}
+	}
+
+	ofstream output(fileName, ios::out | ios::binary | ios::trunc);
+	output.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+	output.close();
+
+	if (output.fail())
+	{
+		fprintf(stderr, "FATAL:\tCan't write checkpoint \"%s\"\n", fileName.c_str());
+		exit(1);
+	}
+
+	//IDs of the next run have to continue the dictionary
+	if (!binary)
+	{
+		ifstream dictionary(dictionaryFileName, ios::in | ios::binary);
+		if (dictionary.fail())
+		{
+			fprintf(stderr, "FATAL:\tCan't open dictionary \"%s\"\n", dictionaryFileName.c_str());
+			exit(1);
+		}
+
+		//copying of empty stream would fail
+		ofstream dictionaryCopy(fileName + ".dat", ios::out | ios::binary | ios::trunc);
+		if (dictionary.peek() != EOF)
+		{
+			dictionaryCopy << dictionary.rdbuf();
+		}
+		dictionaryCopy.close();
+
+		if (dictionaryCopy.fail())
+		{
+			fprintf(stderr, "FATAL:\tCan't write dictionary of checkpoint \"%s\"\n", fileName.c_str());
+			exit(1);
+		}
+	}
+}
+
+void Checkpoint::Update(const vector<int>& symbols, int windowSize)
+{
+	size_t start = (symbols.size() > (size_t)windowSize) ? symbols.size() - windowSize : 0;
+	this->symbols.insert(this->symbols.end(), symbols.begin() + start, symbols.end());
+
+	if (this->symbols.size() > (size_t)windowSize)
+	{
+		this->symbols.erase(this->symbols.begin(), this->symbols.end() - windowSize);
+	}
+}
+
+void Checkpoint::ReadFileEnd(const string& fileName, long long offset, int count, vector<int>& symbols)
+{
+	ifstream input(fileName, ios::in | ios::binary | ios::ate);
+	long long size = (long long)input.tellg();
+	long long start = (size - count > offset) ? size - count : offset;
+
+	vector<char> bytes(size > start ? size - start : 0);
+	input.seekg(start);
+	input.read(bytes.data(), bytes.size());
+	input.close();
+
+	symbols.resize(bytes.size());
+	for (size_t i = 0; i < bytes.size(); i++)
+	{
+		symbols[i] = (unsigned char)bytes[i];
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <string>
+#include <vector>
+
+using namespace std;
+
+typedef unsigned char uchar;
+
+/**
+ * <summary> State that lets compression continue where the last run ended. It keeps the last window of symbols (token IDs or
+ *  bytes) and the number of input bytes compressed so far. A resumed run compresses only the bytes appended since then into a
+ *  continuation segment - the window is primed with the saved symbols on both sides, so the segment refers to the earlier
+ *  data. The decompressor saves the same checkpoint from the decoded data. In token mode the dictionary is saved next to it
+ *  (the checkpoint file name with ".dat"), so IDs of known tokens stay the same. The file has magic, mode byte, number of
+ *  input bytes, number of symbols and the symbols - all values big-endian, the magic little-endian as in frame header.</summary>
+ */
+
+class Checkpoint
+{
+	public:
+		static const unsigned int Magic = 0x4b435453;	///< "STCK" - the first bytes of checkpoint file
+		static const int HeaderSize = 17;				///< Number of bytes in front of the symbols
+
+		/**
+		 * <summary> Constructor - empty checkpoint.</summary>
+		 *
+		 * <param name="binary"> Whether the symbols are bytes (byte mode) rather than token IDs.</param>
+		 */
+
+		Checkpoint(bool binary);
+
+		/**
+		 * <summary> Loads the checkpoint from file - the mode has to be the same as of this run.</summary>
+		 *
+		 * <param name="fileName"> Filename of the checkpoint.</param>
+		 */
+
+		void Load(const string& fileName);
+
+		/**
+		 * <summary> Saves the checkpoint to file, in token mode together with the dictionary.</summary>
+		 *
+		 * <param name="fileName">			 Filename of the checkpoint.</param>
+		 * <param name="dictionaryFileName"> Filename of the dictionary of the last run (token mode).</param>
+		 */
+
+		void Save(const string& fileName, const string& dictionaryFileName);
+
+		/**
+		 * <summary> Appends symbols of the last run and keeps only the last window of them.</summary>
+		 *
+		 * <param name="symbols">	 The symbols (the end of them is enough).</param>
+		 * <param name="windowSize"> Size of the sliding window.</param>
+		 */
+
+		void Update(const vector<int>& symbols, int windowSize);
+
+		/**
+		 * <summary> Reads the last bytes of file as symbols (byte mode).</summary>
+		 *
+		 * <param name="fileName"> Filename of the file.</param>
+		 * <param name="offset">   The first byte that may be read.</param>
+		 * <param name="count">	   The maximal number of bytes.</param>
+		 * <param name="symbols">  The symbols.</param>
+		 */
+
+		static void ReadFileEnd(const string& fileName, long long offset, int count, vector<int>& symbols);
+
+		const vector<int>& GetSymbols() const;
+		long long GetInputBytes() const;
+		void SetInputBytes(long long inputBytes);
+
+	private:
+		static const short SymbolSize = 4;	///< Number of bytes of one saved symbol
+
+		bool binary;				///< Whether the symbols are bytes
+		long long inputBytes;		///< Number of input bytes compressed up to the checkpoint
+		vector<int> symbols;		///< The last window of symbols
+};
+
+
+inline const vector<int>& Checkpoint::GetSymbols() const
+{
+	return symbols;
+}
+
+inline long long Checkpoint::GetInputBytes() const
+{
+	return inputBytes;
+}
+
+inline void Checkpoint::SetInputBytes(long long inputBytes)
+{
+	this->inputBytes = inputBytes;
+}
@@ -0,0 +1,18 @@
+#include "CompressionLevel.h"
+
+CompressionLevel CompressionLevel::Get(int level)
+{
+	switch (level)
+	{
+		case 1:
+			return CompressionLevel(HashChainEngine, 4, GreedyParsing);
+		case 2:
+			return CompressionLevel(HashChainEngine, 16, LazyParsing);
+		case 3:
+			return CompressionLevel(HashChainEngine, 64, LazyParsing);
+		case 5:
+			return CompressionLevel(SuffixArrayEngine, 64, OptimalParsing);
+		default:
+			return CompressionLevel(SuffixTreeEngine, 64, LazyParsing);
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "MatchEngine.h"
+#include "Parsing.h"
+
+/**
+ * <summary> A struct with settings of one compression level - which engine finds matches and how they are chosen.</summary>
+ */
+
+struct CompressionLevel
+{
+	public:
+		static const int MinLevel = 1;		///< The fastest level
+		static const int DefaultLevel = 4;	///< The online suffix tree
+		static const int MaxLevel = 5;		///< The level with the best ratio (archival)
+
+		MatchEngineEnum Engine;		///< The engine for finding matches
+		int ChainDepth;				///< Maximal number of candidates checked per position (hash chain engine)
+		ParsingEnum Parsing;		///< The way matches and literals are chosen (block engines)
+		bool Sparse;				///< Whether only word boundaries are indexed (hash chain engine)
+
+		CompressionLevel() = default;
+		CompressionLevel(MatchEngineEnum engine, int chainDepth, ParsingEnum parsing)
+		{
+			this->Engine = engine;
+			this->ChainDepth = chainDepth;
+			this->Parsing = parsing;
+			this->Sparse = false;
+		}
+
+		/**
+		 * <summary> Gets settings of the level.</summary>
+		 *
+		 * <param name="level"> The level (MinLevel - MaxLevel).</param>
+		 *
+		 * <returns> The settings.</returns>
+		 */
+
+		static CompressionLevel Get(int level);
+};
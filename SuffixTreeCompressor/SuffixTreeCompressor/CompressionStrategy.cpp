@@ -0,0 +1,42 @@
+#include <iostream>
+#include "CompressionStrategy.h"
+
+StrategyLog::StrategyLog()
+{
+	for (int i = 0; i < StrategiesCount; i++)
+	{
+		this->counts[i] = 0;
+	}
+}
+
+void StrategyLog::Add(CompressionStrategyEnum strategy)
+{
+	strategies.push_back(strategy);
+	counts[strategy]++;
+}
+
+void StrategyLog::Write(const char * blockName, const char * levelName) const
+{
+	if (strategies.empty())
+		return;
+
+	const char * names[StrategiesCount] = { levelName, "fast", "stored" };
+
+	cout << blockName << ":";
+	size_t first = 0;
+	for (size_t i = 1; i <= strategies.size(); i++)
+	{
+		if (i < strategies.size() && strategies[i] == strategies[first])
+			continue;
+
+		cout << ((first == 0) ? " " : ", ") << first;
+		if (i - 1 > first)
+		{
+			cout << "-" << i - 1;
+		}
+		cout << " " << names[strategies[first]];
+
+		first = i;
+	}
+	cout << endl;
+}
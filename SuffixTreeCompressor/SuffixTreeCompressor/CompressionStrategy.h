@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+
+using namespace std;
+
+/**
+ * <summary> Values that represent strategies for compressing a block - from the best ratio to the fastest. Compression
+ *  with time budget moves to the next one when the budget is at risk.</summary>
+ */
+
+enum CompressionStrategyEnum
+{
+	LevelStrategy,		///< Engine and parsing of the compression level
+	FastStrategy,		///< Hash chains with small search depth and greedy parsing (block engines)
+	StoredStrategy,		///< Blocks are stored without compression
+	StrategiesCount		///< Number of strategies
+};
+
+/**
+ * <summary> Strategy of every compressed block in order, so that statistics show which blocks were compressed by which
+ *  strategy.</summary>
+ */
+
+class StrategyLog
+{
+	public:
+		StrategyLog();
+
+		/**
+		 * <summary> Adds the next block.</summary>
+		 *
+		 * <param name="strategy"> Strategy the block was compressed by.</param>
+		 */
+
+		void Add(CompressionStrategyEnum strategy);
+
+		/**
+		 * <summary> Gets number of blocks compressed by the strategy.</summary>
+		 *
+		 * <param name="strategy"> The strategy.</param>
+		 *
+		 * <returns> The number of blocks.</returns>
+		 */
+
+		long long GetCount(CompressionStrategyEnum strategy) const;
+
+		/**
+		 * <summary> Writes the blocks as ranges of consecutive blocks (numbered from zero) with the same strategy.</summary>
+		 *
+		 * <param name="blockName"> Name of the blocks (e.g. "Chunks").</param>
+		 * <param name="levelName"> Name of LevelStrategy (e.g. the engine).</param>
+		 */
+
+		void Write(const char * blockName, const char * levelName) const;
+
+	private:
+		vector<CompressionStrategyEnum> strategies;	///< Strategy of every block
+		long long counts[StrategiesCount];			///< Number of blocks of every strategy
+};
+
+inline long long StrategyLog::GetCount(CompressionStrategyEnum strategy) const
+{
+	return counts[strategy];
+}
@@ -0,0 +1,130 @@
+#include "Crc32c.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CRC32C_X86
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+//GCC and Clang compile the instruction only in functions that are allowed to use it
+#if defined(CRC32C_X86) && defined(__GNUC__)
+#define CRC32C_TARGET __attribute__((target("sse4.2")))
+#else
+#define CRC32C_TARGET
+#endif
+
+unsigned int Crc32c::table[256];
+bool Crc32c::hardware = Crc32c::Initialize();
+
+Crc32c::Crc32c()
+{
+	Reset();
+}
+
+void Crc32c::Reset()
+{
+	this->state = 0xffffffff;
+	this->bufferedBytes = 0;
+}
+
+void Crc32c::Update(const uchar * bytes, size_t count)
+{
+	FlushBuffer();
+	state = hardware ? UpdateHardware(state, bytes, count) : UpdateTable(state, bytes, count);
+}
+
+unsigned int Crc32c::GetValue()
+{
+	FlushBuffer();
+	return ~state;
+}
+
+unsigned int Crc32c::Compute(const uchar * bytes, size_t count)
+{
+	Crc32c checksum;
+	checksum.Update(bytes, count);
+	return checksum.GetValue();
+}
+
+bool Crc32c::IsHardwareAccelerated()
+{
+	return hardware;
+}
+
+void Crc32c::FlushBuffer()
+{
+	if (bufferedBytes == 0)
+		return;
+
+	state = hardware ? UpdateHardware(state, buffer, bufferedBytes) : UpdateTable(state, buffer, bufferedBytes);
+	bufferedBytes = 0;
+}
+
+CRC32C_TARGET unsigned int Crc32c::UpdateHardware(unsigned int state, const uchar * bytes, size_t count)
+{
+#ifdef CRC32C_X86
+	size_t i = 0;
+
+#if defined(_M_X64) || defined(__x86_64__)
+	unsigned long long wideState = state;
+	for (; i + 8 <= count; i += 8)
+	{
+		unsigned long long word = 0;
+		for (short j = 7; j >= 0; j--)
+		{
+			word = (word << 8) | bytes[i + j];
+		}
+		wideState = _mm_crc32_u64(wideState, word);
+	}
+	state = (unsigned int)wideState;
+#endif
+
+	for (; i < count; i++)
+	{
+		state = _mm_crc32_u8(state, bytes[i]);
+	}
+
+	return state;
+#else
+	return UpdateTable(state, bytes, count);
+#endif
+}
+
+unsigned int Crc32c::UpdateTable(unsigned int state, const uchar * bytes, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		state = table[(state ^ bytes[i]) & 0xff] ^ (state >> 8);
+	}
+
+	return state;
+}
+
+bool Crc32c::Initialize()
+{
+	//reflected Castagnoli polynomial
+	for (unsigned int i = 0; i < 256; i++)
+	{
+		unsigned int value = i;
+		for (short j = 0; j < 8; j++)
+		{
+			value = (value & 1) ? (value >> 1) ^ 0x82f63b78 : value >> 1;
+		}
+		table[i] = value;
+	}
+
+#if defined(CRC32C_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 20)) != 0;
+#elif defined(CRC32C_X86)
+	unsigned int eax, ebx, ecx, edx;
+	return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_2) != 0;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include <stddef.h>
+
+typedef unsigned char uchar;
+
+/**
+ * <summary> CRC32C (Castagnoli) checksum. It is computed by crc32 instruction of SSE4.2 if the processor has it, otherwise
+ *  by table of bytes - both give the same value. Symbols are checksummed as their bytes from the lowest one, so the value
+ *  doesn't depend on byte order of the machine.</summary>
+ */
+
+class Crc32c
+{
+	public:
+		static const int BufferSize = 256;	///< Number of bytes of symbols that are collected before they are checksummed
+
+		Crc32c();
+
+		/**
+		 * <summary> Starts new checksum.</summary>
+		 */
+
+		void Reset();
+
+		/**
+		 * <summary> Adds bytes to the checksum.</summary>
+		 *
+		 * <param name="bytes"> The bytes.</param>
+		 * <param name="count"> Number of bytes.</param>
+		 */
+
+		void Update(const uchar * bytes, size_t count);
+
+		/**
+		 * <summary> Adds symbol to the checksum.</summary>
+		 *
+		 * <param name="symbol"> The symbol.</param>
+		 */
+
+		template <typename T>
+		void UpdateSymbol(T symbol);
+
+		/**
+		 * <summary> Adds symbols to the checksum.</summary>
+		 *
+		 * <param name="symbols"> The symbols.</param>
+		 * <param name="count">   Number of symbols.</param>
+		 */
+
+		template <typename T>
+		void UpdateSymbols(const T * symbols, int count);
+
+		/**
+		 * <summary> Gets the checksum of everything added since the last Reset.</summary>
+		 *
+		 * <returns> The checksum.</returns>
+		 */
+
+		unsigned int GetValue();
+
+		/**
+		 * <summary> Computes checksum of bytes.</summary>
+		 *
+		 * <param name="bytes"> The bytes.</param>
+		 * <param name="count"> Number of bytes.</param>
+		 *
+		 * <returns> The checksum.</returns>
+		 */
+
+		static unsigned int Compute(const uchar * bytes, size_t count);
+
+		/**
+		 * <summary> Gets whether the processor computes checksums by crc32 instruction.</summary>
+		 *
+		 * <returns> True if SSE4.2 is used.</returns>
+		 */
+
+		static bool IsHardwareAccelerated();
+
+	private:
+		unsigned int state;			///< The inverted checksum of the bytes that are not in buffer
+		uchar buffer[BufferSize];	///< Bytes of symbols that are not checksummed yet
+		int bufferedBytes;			///< Number of bytes in buffer
+
+		static bool hardware;				///< Whether SSE4.2 is available
+		static unsigned int table[256];		///< Checksum of every byte (for processors without SSE4.2)
+
+		/**
+		 * <summary> Checksums the buffered bytes.</summary>
+		 */
+
+		void FlushBuffer();
+
+		/**
+		 * <summary> Updates inverted checksum by crc32 instruction.</summary>
+		 *
+		 * <param name="state"> The inverted checksum.</param>
+		 * <param name="bytes"> The bytes.</param>
+		 * <param name="count"> Number of bytes.</param>
+		 *
+		 * <returns> The new inverted checksum.</returns>
+		 */
+
+		static unsigned int UpdateHardware(unsigned int state, const uchar * bytes, size_t count);
+
+		/**
+		 * <summary> Updates inverted checksum by table.</summary>
+		 *
+		 * <param name="state"> The inverted checksum.</param>
+		 * <param name="bytes"> The bytes.</param>
+		 * <param name="count"> Number of bytes.</param>
+		 *
+		 * <returns> The new inverted checksum.</returns>
+		 */
+
+		static unsigned int UpdateTable(unsigned int state, const uchar * bytes, size_t count);
+
+		/**
+		 * <summary> Detects SSE4.2 and fills the table.</summary>
+		 *
+		 * <returns> True if SSE4.2 is available.</returns>
+		 */
+
+		static bool Initialize();
+};
+
+
+template <typename T>
+inline void Crc32c::UpdateSymbol(T symbol)
+{
+	for (short i = 0; i < (short)sizeof(T); i++)
+	{
+		buffer[bufferedBytes++] = (uchar)((unsigned long long)symbol >> (8 * i));
+	}
+
+	if (bufferedBytes > BufferSize - 8)
+	{
+		FlushBuffer();
+	}
+}
+
+template <typename T>
+void Crc32c::UpdateSymbols(const T * symbols, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		UpdateSymbol(symbols[i]);
+	}
+}
@@ -2,10 +2,11 @@
 #include "Decoder.h"
 
 
-Decoder::Decoder(short matchLengthSizeBits, short matchBytesCount)
+Decoder::Decoder(short matchLengthSizeBits, short matchBits, bool repeatCodes)
 {
 	this->matchLengthSizeBits = matchLengthSizeBits;
-	this->matchBytesCount = matchBytesCount;
+	this->matchBits = matchBits;
+	this->repeatCodes = repeatCodes;
 }
 
 DecodeResultEnum Decoder::DecodeBit(uchar byte, int bitIndex)
@@ -17,18 +18,3 @@ DecodeResultEnum Decoder::DecodeBit(uchar byte, int bitIndex)
 
 	return DecodeResultEnum::MatchResult;
 }
-
-Match Decoder::DecodeMatch(uchar * bytesToDecode)
-{
-	int value = 0;
-	for (short i = 0; i < matchBytesCount; i++)
-	{
-		value |= bytesToDecode[i] << BytesCnt2BitsCnt(matchBytesCount - i - 1);
-	}
-
-	int matchLengthMask = (1 << this->matchLengthSizeBits) - 1;
-	int matchIndex = value >> matchLengthSizeBits;
-	int matchLength = value & matchLengthMask;
-
-	return Match(matchIndex, matchLength);
-}
\ No newline at end of file
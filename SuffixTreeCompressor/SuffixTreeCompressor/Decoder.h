@@ -1,6 +1,7 @@
 #pragma once
 #include "DecodeResult.h"
 #include "MatchStruct.h"
+#include "Encoder.h"
 
 /**
  * <summary> A decoder for matches and bits in flags byte.</summary>
@@ -12,7 +13,7 @@ class Decoder
 {
 	public:
 		Decoder() = default;
-		Decoder(short matchLengthSizeBits, short matchBytesCount);
+		Decoder(short matchLengthSizeBits, short matchBits, bool repeatCodes = false);
 		~Decoder() = default;
 
 		/**
@@ -27,17 +28,142 @@ class Decoder
 		DecodeResultEnum DecodeBit(uchar byte, int bitIndex);
 
 		/**
-		 * <summary> Decode match from matchBytes into Match struct.</summary>
+		 * <summary> Decode match from its bit field into Match struct.</summary>
 		 *
-		 * <param name="bytesToDecode"> The bytes to decode.</param>
+		 * <param name="code"> The match code.</param>
 		 *
 		 * <returns> A decoded match.</returns>
 		 */
 
-		Match DecodeMatch(uchar * bytesToDecode);
+		Match DecodeMatch(unsigned long long code);
+
+		/**
+		 * <summary> Decode match from its bit field into Match struct, with match layout known at compile time.</summary>
+		 *
+		 * <param name="code"> The match code.</param>
+		 *
+		 * <returns> A decoded match.</returns>
+		 */
+
+		template <short MatchLengthSizeBits>
+		static Match DecodeMatch(unsigned long long code);
+
+		/**
+		 * <summary> Checks whether length extension follows the match - its length field holds escape.</summary>
+		 *
+		 * <param name="match">				  The decoded match.</param>
+		 * <param name="matchLengthSizeBits"> The bits size of match length.</param>
+		 *
+		 * <returns> True if the match is extended.</returns>
+		 */
+
+		static bool IsExtended(Match match, short matchLengthSizeBits);
+
+		/**
+		 * <summary> Adds one byte of length extension to match length.</summary>
+		 *
+		 * <param name="match">		The match.</param>
+		 * <param name="byte">		The extension byte.</param>
+		 * <param name="byteIndex"> Index of the byte in extension.</param>
+		 *
+		 * <returns> True if another extension byte follows.</returns>
+		 */
+
+		static bool ExtendLength(Match & match, uchar byte, short byteIndex);
+
+		/**
+		 * <summary> Decode repeat code (behind its flag bit) into Match struct - index is taken from the history of the last
+		 *  match indices.</summary>
+		 *
+		 * <param name="code"> The slot and length field.</param>
+		 *
+		 * <returns> A decoded match.</returns>
+		 */
+
+		Match DecodeRepeatMatch(unsigned long long code);
+
+		/**
+		 * <summary> Moves index of decoded match to the front of history of the last indices, the same way as the encoder does.</summary>
+		 *
+		 * <param name="matchIndex"> The match index.</param>
+		 */
+
+		void UpdateRepeatOffsets(int matchIndex);
+
+		/**
+		 * <summary> Forgets the last match indices (start of independent block).</summary>
+		 */
+
+		void ResetRepeatOffsets();
+
+		/**
+		 * <summary> Checks whether every match starts with flag bit of repeat code.</summary>
+		 *
+		 * <returns> True if repeat codes are used.</returns>
+		 */
+
+		bool HasRepeatCodes() const;
+
+		/**
+		 * <summary> Gets number of bits per one match.</summary>
+		 *
+		 * <returns> The match bits.</returns>
+		 */
+
+		short GetMatchBits() const;
 
 	private:
 		short matchLengthSizeBits;  ///< The bits size of match length (max length of 3 occupy 2 bits, max length of 31 occupy 5 bits etc.)
-		short matchBytesCount;		///< Total bytes num that one match occupy - (bits for index + bits for length) / 8
+		short matchBits;			///< Total bits that one match occupy - bits for index + bits for length
+		bool repeatCodes;			///< Whether matches that reuse the last match indices have repeat codes
+		RepeatOffsets repeatOffsets;	///< The last match indices
 };
 
+template <short MatchLengthSizeBits>
+Match Decoder::DecodeMatch(unsigned long long code)
+{
+	return Match((int)(code >> MatchLengthSizeBits), (int)(code & ((1ULL << MatchLengthSizeBits) - 1)));
+}
+
+inline Match Decoder::DecodeMatch(unsigned long long code)
+{
+	return Match((int)(code >> matchLengthSizeBits), (int)(code & ((1ULL << matchLengthSizeBits) - 1)));
+}
+
+inline bool Decoder::IsExtended(Match match, short matchLengthSizeBits)
+{
+	return match.MatchLength == (1 << matchLengthSizeBits) - 1;
+}
+
+inline bool Decoder::ExtendLength(Match & match, uchar byte, short byteIndex)
+{
+	match.MatchLength += (byte & 0x7f) << (7 * byteIndex);
+	return (byte & 0x80) != 0 && byteIndex + 1 < Encoder::MaxExtensionBytes;
+}
+
+inline Match Decoder::DecodeRepeatMatch(unsigned long long code)
+{
+	return Match(repeatOffsets.Get((short)(code >> matchLengthSizeBits)), (int)(code & ((1ULL << matchLengthSizeBits) - 1)));
+}
+
+inline void Decoder::UpdateRepeatOffsets(int matchIndex)
+{
+	if (repeatCodes)
+		repeatOffsets.Update(matchIndex);
+}
+
+inline void Decoder::ResetRepeatOffsets()
+{
+	repeatOffsets.Reset();
+}
+
+inline bool Decoder::HasRepeatCodes() const
+{
+	return repeatCodes;
+}
+
+inline short Decoder::GetMatchBits() const
+{
+	return matchBits;
+}
+
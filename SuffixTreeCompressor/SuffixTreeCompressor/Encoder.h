@@ -1,8 +1,12 @@
 #pragma once
 #include "MatchStruct.h"
+#include "RepeatOffsets.h"
 
 /**
- * <summary> An encoder that encodes matches.</summary>
+ * <summary> An encoder that encodes matches into bit fields - index in the buffer followed by length, without any
+ *  padding bits. The biggest value of length field is escape - the rest of length follows in extension bytes (7 bits
+ *  per byte, the lowest first, the highest bit tells that another byte follows). With repeat codes every match starts
+ *  with flag bit - one for repeat code (slot of the reused match index and length), zero for full match code.</summary>
  */
 
 typedef unsigned char uchar;
@@ -10,21 +14,188 @@ typedef unsigned char uchar;
 class Encoder
 {
 	public:
+		static const short MaxExtensionBytes = 4;						///< The most bytes of length extension
+		static const int MaxLengthExtension = (1 << (7 * MaxExtensionBytes)) - 1;	///< The biggest length that extension holds
+
 		Encoder() = default;
-		Encoder(short matchLengthBits, short matchBytesCount);
+		Encoder(short matchLengthBits, short matchBits, bool repeatCodes = false);
 		~Encoder() = default;
 
 		/**
-		 * <summary> Encode match into bytes.</summary>
+		 * <summary> Encode match into bit field.</summary>
+		 *
+		 * <param name="match"> Specifies the match.</param>
+		 *
+		 * <returns> The match code (the lowest GetMatchBits() bits).</returns>
+		 */
+
+		unsigned long long EncodeMatch(Match match);
+
+		/**
+		 * <summary> Encode match into bit field, with match layout known at compile time.</summary>
 		 *
 		 * <param name="match"> Specifies the match.</param>
-		 * <param name="bytes"> The match bytes.</param>
+		 *
+		 * <returns> The match code.</returns>
+		 */
+
+		template <short MatchLengthBits>
+		static unsigned long long EncodeMatch(Match match);
+
+		/**
+		 * <summary> Encode the rest of length of match whose length doesn't fit into length field.</summary>
+		 *
+		 * <param name="matchLength">	  The match length.</param>
+		 * <param name="matchLengthBits"> The number of bits of length field.</param>
+		 * <param name="bytes">			  The extension bytes (MaxExtensionBytes).</param>
+		 *
+		 * <returns> Number of extension bytes (zero if the length fits).</returns>
 		 */
 
-		void EncodeMatch(Match match, uchar * bytes);
+		static short EncodeLengthExtension(int matchLength, short matchLengthBits, uchar * bytes);
+
+		/**
+		 * <summary> Gets the longest match that can be encoded.</summary>
+		 *
+		 * <param name="matchLengthBits"> The number of bits of length field.</param>
+		 *
+		 * <returns> The maximal match length.</returns>
+		 */
+
+		static int MaxMatchLength(short matchLengthBits);
+
+		/**
+		 * <summary> Moves the match index to the front of history of the last indices.</summary>
+		 *
+		 * <param name="matchIndex"> The index of match that is written.</param>
+		 *
+		 * <returns> Slot the index had in the history - the match goes out as repeat code, -1 if it needs full code (or
+		 *  repeat codes are not used).</returns>
+		 */
+
+		short UpdateRepeatOffsets(int matchIndex);
+
+		/**
+		 * <summary> Encode match that reuses match index of the slot into repeat code.</summary>
+		 *
+		 * <param name="slot">		  The slot of match index.</param>
+		 * <param name="matchLength"> The match length.</param>
+		 *
+		 * <returns> The repeat code (the lowest GetRepeatMatchBits() bits).</returns>
+		 */
+
+		unsigned long long EncodeRepeatMatch(short slot, int matchLength);
+
+		/**
+		 * <summary> Forgets the last match indices (start of independent block).</summary>
+		 */
+
+		void ResetRepeatOffsets();
+
+		/**
+		 * <summary> Gets match index of the slot of history - candidate that makes the match cheaper.</summary>
+		 *
+		 * <param name="slot"> The slot.</param>
+		 *
+		 * <returns> The match index (zero if the slot is empty or repeat codes are not used).</returns>
+		 */
+
+		int GetRepeatOffset(short slot) const;
+
+		/**
+		 * <summary> Gets number of bits per one match - the full code with its flag bit.</summary>
+		 *
+		 * <returns> The match bits.</returns>
+		 */
+
+		short GetMatchBits() const;
+
+		/**
+		 * <summary> Gets number of bits per one repeat code with its flag bit.</summary>
+		 *
+		 * <returns> The repeat match bits.</returns>
+		 */
+
+		short GetRepeatMatchBits() const;
 
 	private:
 		short matchLengthBits;  ///< The number of bits that are reserved for match length
-		short matchBytesCount;  ///< Number of bytes per one match
+		short matchBits;		///< Number of bits per one match (index bits + length bits + flag bit of repeat codes)
+		bool repeatCodes;		///< Whether matches that reuse the last match indices get repeat codes
+		RepeatOffsets repeatOffsets;	///< The last match indices
 };
 
+template <short MatchLengthBits>
+unsigned long long Encoder::EncodeMatch(Match match)
+{
+	const int escape = (1 << MatchLengthBits) - 1;
+	return ((unsigned long long)match.MatchIndex << MatchLengthBits) | (unsigned long long)(match.MatchLength < escape ? match.MatchLength : escape);
+}
+
+inline unsigned long long Encoder::EncodeMatch(Match match)
+{
+	int escape = (1 << matchLengthBits) - 1;
+	return ((unsigned long long)match.MatchIndex << matchLengthBits) | (unsigned long long)(match.MatchLength < escape ? match.MatchLength : escape);
+}
+
+inline short Encoder::EncodeLengthExtension(int matchLength, short matchLengthBits, uchar * bytes)
+{
+	int extension = matchLength - ((1 << matchLengthBits) - 1);
+	if (extension < 0)
+		return 0;
+
+	short count = 0;
+	do
+	{
+		bytes[count] = extension & 0x7f;
+		extension >>= 7;
+		if (extension > 0)
+			bytes[count] |= 0x80;
+
+		count++;
+	} while (extension > 0);
+
+	return count;
+}
+
+inline int Encoder::MaxMatchLength(short matchLengthBits)
+{
+	return (1 << matchLengthBits) - 1 + MaxLengthExtension;
+}
+
+inline short Encoder::UpdateRepeatOffsets(int matchIndex)
+{
+	if (!repeatCodes)
+		return -1;
+
+	short slot = repeatOffsets.Find(matchIndex);
+	repeatOffsets.Update(matchIndex);
+	return slot;
+}
+
+inline unsigned long long Encoder::EncodeRepeatMatch(short slot, int matchLength)
+{
+	int escape = (1 << matchLengthBits) - 1;
+	return (((1ULL << RepeatOffsets::SlotBits) | slot) << matchLengthBits) | (unsigned long long)(matchLength < escape ? matchLength : escape);
+}
+
+inline void Encoder::ResetRepeatOffsets()
+{
+	repeatOffsets.Reset();
+}
+
+inline int Encoder::GetRepeatOffset(short slot) const
+{
+	return repeatCodes ? repeatOffsets.Get(slot) : 0;
+}
+
+inline short Encoder::GetMatchBits() const
+{
+	return matchBits;
+}
+
+inline short Encoder::GetRepeatMatchBits() const
+{
+	return 1 + RepeatOffsets::SlotBits + matchLengthBits;
+}
+
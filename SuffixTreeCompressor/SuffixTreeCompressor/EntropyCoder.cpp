@@ -0,0 +1,470 @@
+#include "EntropyCoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "FrameHeader.h"
+#include "StoredBlock.hh"
+#include "LongRangeMatcher.hh"
+
+EntropyCoder::EntropyCoder(short symbolWidth, short windowBits, short matchLengthBits, bool repeatCodes)
+	: literals(AlphabetSize(symbolWidth == 1 ? ByteLiteralDirectBits : TokenLiteralDirectBits)), lengths(AlphabetSize(LengthDirectBits)), distances(AlphabetSize(DistanceDirectBits))
+{
+	this->symbolWidth = symbolWidth;
+	this->matchLengthBits = matchLengthBits;
+	this->matchBits = windowBits + 1 + matchLengthBits;
+	this->bufferSize = 2 << windowBits;
+	this->literalDirectBits = (symbolWidth == 1) ? ByteLiteralDirectBits : TokenLiteralDirectBits;
+	this->repeatCodes = repeatCodes;
+	this->distanceBias = repeatCodes ? RepeatOffsets::Count - 1 : 0;
+	this->encoder = Encoder(matchLengthBits, matchBits, repeatCodes);
+	this->decoder = Decoder(matchLengthBits, matchBits);
+	this->restoredBytes = 0;
+	this->codedBytes = 0;
+}
+
+void EntropyCoder::EncodeFile(const string& fileName)
+{
+	ifstream input(fileName, ios::in | ios::binary);
+	string codedFileName = fileName + ".tmp";
+	ofstream output(codedFileName, ios::out | ios::binary);
+
+	FrameHeader header = FrameHeader::Read(fileName);
+	header.Flags |= FrameHeader::EntropyFlag;
+	uchar headerBytes[FrameHeader::Size];
+	header.Encode(headerBytes);
+	output.write(reinterpret_cast<char *>(headerBytes), FrameHeader::Size);
+	input.seekg(FrameHeader::Size);
+	codedBytes = FrameHeader::Size;
+
+	//groups are collected until the block is full, the data are read in chunks of block size and followed by zero padding
+	vector<uchar> data(BitReader::PaddingBytes, 0);
+	long long dataBytes = 0;
+	long long blockStart = 0;
+	long long position = 0;
+	long long streamBits = 0;
+	bool inputEnd = false;
+	bool end = false;
+	while (!end)
+	{
+		long long groupBits = ScanGroup(data.data(), position, dataBytes * 8, MeasureScan, NULL, end);
+		if (groupBits < 0)
+		{
+			if (inputEnd)
+			{
+				fprintf(stderr, "FATAL:\tCompressed file \"%s\" is truncated\n", fileName.c_str());
+				exit(1);
+			}
+
+			data.resize(dataBytes + BlockSize + BitReader::PaddingBytes, 0);
+			input.read(reinterpret_cast<char *>(data.data() + dataBytes), BlockSize);
+			dataBytes += input.gcount();
+			data.resize(dataBytes + BitReader::PaddingBytes);
+			inputEnd = input.gcount() < BlockSize;
+			continue;
+		}
+
+		position += groupBits;
+		if (position - blockStart >= 8LL * BlockSize || end)
+		{
+			EncodeBlock(data.data(), blockStart, position, output);
+			streamBits += position - blockStart;
+
+			//the next block may start inside the byte
+			long long codedDataBytes = position >> 3;
+			data.erase(data.begin(), data.begin() + codedDataBytes);
+			dataBytes -= codedDataBytes;
+			blockStart = position = position & 7;
+		}
+	}
+
+	input.close();
+	output.close();
+	restoredBytes = (streamBits + 7) / 8;
+
+	remove(fileName.c_str());
+	rename(codedFileName.c_str(), fileName.c_str());
+}
+
+void EntropyCoder::DecodeFile(const string& inFile, const string& outFile, long long frameOffset, long long frameEnd)
+{
+	ifstream input(inFile, ios::in | ios::binary);
+	ofstream output(outFile, ios::out | ios::binary);
+
+	FrameHeader header = FrameHeader::Read(inFile, frameOffset);
+	header.Flags &= ~FrameHeader::EntropyFlag;
+	uchar headerBytes[FrameHeader::Size];
+	header.Encode(headerBytes);
+	output.write(reinterpret_cast<char *>(headerBytes), FrameHeader::Size);
+	input.seekg(frameOffset + FrameHeader::Size);
+	restoredBytes = FrameHeader::Size;
+	codedBytes = FrameHeader::Size;
+
+	//blocks don't end at byte border, so the last bits of block stay in the writer
+	vector<uchar> coded;
+	vector<uchar> bytes;
+	BitWriter restored(&bytes);
+	bool end = false;
+	while (!end)
+	{
+		uchar blockHeader[BlockHeaderSize];
+		input.read(reinterpret_cast<char *>(blockHeader), BlockHeaderSize);
+
+		long long blockBits = 0;
+		long long codedCount = 0;
+		for (short i = 0; i < RestoredBitsBytes; i++)
+		{
+			blockBits = (blockBits << 8) | blockHeader[i];
+		}
+		for (short i = 0; i < CodedBytesBytes; i++)
+		{
+			codedCount = (codedCount << 8) | blockHeader[RestoredBitsBytes + i];
+		}
+
+		//the block can't reach into the next frame of archive
+		coded.assign(codedCount + DecodePaddingBytes, 0);
+		input.read(reinterpret_cast<char *>(coded.data()), codedCount);
+		if (input.fail() || frameOffset + codedBytes + BlockHeaderSize + codedCount > frameEnd)
+		{
+			fprintf(stderr, "FATAL:\tEntropy coded file \"%s\" is truncated\n", inFile.c_str());
+			exit(1);
+		}
+
+		BitReader reader(coded.data());
+		literals.ReadLengths(reader);
+		lengths.ReadLengths(reader);
+		distances.ReadLengths(reader);
+
+		long long restoredBits = 0;
+		while (restoredBits < blockBits && !end && reader.GetBytesRead() <= codedCount)
+		{
+			restoredBits += DecodeGroup(reader, restored, codedCount * 8 - reader.GetBitPosition(), end);
+		}
+
+		if (restoredBits != blockBits || reader.GetBytesRead() > codedCount)
+		{
+			fprintf(stderr, "FATAL:\tEntropy coded file \"%s\" is corrupted\n", inFile.c_str());
+			exit(1);
+		}
+
+		if (end)
+		{
+			restored.Flush();
+		}
+
+		output.write(reinterpret_cast<char *>(bytes.data()), bytes.size());
+		restoredBytes += bytes.size();
+		codedBytes += BlockHeaderSize + codedCount;
+		bytes.clear();
+	}
+
+	if (frameOffset + codedBytes != frameEnd)
+	{
+		fprintf(stderr, "FATAL:\tEntropy coded data of \"%s\" don't end at the end of their frame\n", inFile.c_str());
+		exit(1);
+	}
+
+	input.close();
+	output.close();
+}
+
+long long EntropyCoder::ScanGroup(const uchar * bytes, long long position, long long availableBits, ScanEnum scan, BitWriter * writer, bool & end)
+{
+	end = false;
+	if (position + 8 > availableBits)
+		return -1;
+
+	BitReader reader(bytes, position);
+	uchar flagsByte = (uchar)reader.Read(8);
+	if (scan == EncodeScan)
+	{
+		writer->Write(flagsByte, 8);
+	}
+
+	short bitsInByteCount = 8;
+	for (short i = 0; i < bitsInByteCount; i++)
+	{
+		if (flagsByte & (0x80 >> i))
+		{
+			if (reader.GetBitPosition() + 8 * symbolWidth > availableBits)
+				return -1;
+
+			CodeValue(literals, literalDirectBits, reader.Read(8 * symbolWidth), scan, writer);
+			continue;
+		}
+
+		//repeat code has slot in place of index
+		bool repeatCode = false;
+		if (repeatCodes)
+		{
+			if (reader.GetBitPosition() + 1 > availableBits)
+				return -1;
+
+			repeatCode = reader.Read(1) != 0;
+		}
+
+		short codeBits = repeatCode ? RepeatOffsets::SlotBits + matchLengthBits : matchBits;
+		if (reader.GetBitPosition() + codeBits > availableBits)
+			return -1;
+
+		Match match = decoder.DecodeMatch(reader.Read(codeBits));
+		if (match.MatchLength > 0 && Decoder::IsExtended(match, matchLengthBits))
+		{
+			//the whole length is coded, extension bytes are restored from it
+			short extensionByte = 0;
+			do
+			{
+				if (reader.GetBitPosition() + 8 > availableBits)
+					return -1;
+			} while (Decoder::ExtendLength(match, (uchar)reader.Read(8), extensionByte++));
+		}
+
+		//distance back from the front of buffer - near matches get small values, slots of repeat codes are below them
+		CodeValue(lengths, LengthDirectBits, match.MatchLength, scan, writer);
+		if (match.MatchLength > 0)
+		{
+			CodeValue(distances, DistanceDirectBits, repeatCode ? match.MatchIndex : ((bufferSize - match.MatchIndex) & (bufferSize - 1)) + distanceBias, scan, writer);
+			continue;
+		}
+
+		if (match.MatchIndex >= (1 << MarkerBits))
+		{
+			fprintf(stderr, "FATAL:\tUnknown zero-length match %d in compressed data\n", match.MatchIndex);
+			exit(1);
+		}
+
+		if (scan == EncodeScan)
+		{
+			writer->Write(match.MatchIndex, MarkerBits);
+		}
+
+		long long extraBits = 0;
+		if (match.MatchIndex == LongRangeMatcher<uchar>::MarkerIndex)
+		{
+			extraBits = 8 * LongRangeMatcher<uchar>::ExtraBytesCount;
+		}
+		else if (match.MatchIndex == StoredBlock<uchar>::MarkerIndex)
+		{
+			if (reader.GetBitPosition() + 8 * StoredBlock<uchar>::ExtraBytesCount > availableBits)
+				return -1;
+
+			uchar lengthBytes[StoredBlock<uchar>::ExtraBytesCount];
+			BitReader lengthReader(bytes, reader.GetBitPosition());
+			for (short j = 0; j < StoredBlock<uchar>::ExtraBytesCount; j++)
+			{
+				lengthBytes[j] = (uchar)lengthReader.Read(8);
+			}
+
+			extraBits = 8 * (StoredBlock<uchar>::ExtraBytesCount + (long long)StoredBlock<uchar>::DecodeLength(lengthBytes) * symbolWidth);
+		}
+		else
+		{
+			//end of data - the rest of group follows
+			end = true;
+			bitsInByteCount = match.MatchIndex + 1;
+		}
+
+		if (reader.GetBitPosition() + extraBits > availableBits)
+			return -1;
+
+		if (scan == EncodeScan)
+		{
+			for (long long j = 0; j < extraBits; j += 8)
+			{
+				writer->Write(reader.Read(8), 8);
+			}
+		}
+		else
+			reader.Skip(extraBits);
+
+		//stored block ends the group
+		if (match.MatchIndex == StoredBlock<uchar>::MarkerIndex)
+			break;
+	}
+
+	return reader.GetBitPosition() - position;
+}
+
+long long EntropyCoder::DecodeGroup(BitReader & reader, BitWriter & restored, long long availableBits, bool & end)
+{
+	uchar flagsByte = (uchar)reader.Read(8);
+	restored.Write(flagsByte, 8);
+	long long restoredBits = 8;
+
+	short bitsInByteCount = 8;
+	for (short i = 0; i < bitsInByteCount; i++)
+	{
+		if (flagsByte & (0x80 >> i))
+		{
+			restored.Write(DecodeValue(literals, literalDirectBits, reader), 8 * symbolWidth);
+			restoredBits += 8 * symbolWidth;
+			continue;
+		}
+
+		unsigned long long codedLength = DecodeValue(lengths, LengthDirectBits, reader);
+		if (codedLength > (unsigned long long)Encoder::MaxMatchLength(matchLengthBits))
+		{
+			fprintf(stderr, "FATAL:\tEntropy coded match length %llu is too long\n", codedLength);
+			exit(1);
+		}
+
+		int matchLength = (int)codedLength;
+		int matchIndex = 0;
+		unsigned long long distance = 0;
+		if (matchLength > 0)
+			distance = DecodeValue(distances, DistanceDirectBits, reader);
+		else
+			matchIndex = (int)reader.Read(MarkerBits);
+
+		if (matchLength > 0 && repeatCodes && distance < RepeatOffsets::Count)
+		{
+			restored.Write(encoder.EncodeRepeatMatch((short)distance, matchLength), encoder.GetRepeatMatchBits());
+			restoredBits += encoder.GetRepeatMatchBits();
+		}
+		else
+		{
+			if (matchLength > 0)
+				matchIndex = (bufferSize - (int)(distance - distanceBias)) & (bufferSize - 1);
+
+			restored.Write(encoder.EncodeMatch(Match(matchIndex, matchLength)), encoder.GetMatchBits());
+			restoredBits += encoder.GetMatchBits();
+		}
+
+		if (matchLength > 0)
+		{
+			uchar extensionBytes[Encoder::MaxExtensionBytes];
+			short extensionBytesCount = Encoder::EncodeLengthExtension(matchLength, matchLengthBits, extensionBytes);
+			for (short j = 0; j < extensionBytesCount; j++)
+			{
+				restored.Write(extensionBytes[j], 8);
+			}
+			restoredBits += 8 * extensionBytesCount;
+			continue;
+		}
+
+		long long extraBytesCount = 0;
+		if (matchIndex == LongRangeMatcher<uchar>::MarkerIndex)
+		{
+			extraBytesCount = LongRangeMatcher<uchar>::ExtraBytesCount;
+		}
+		else if (matchIndex == StoredBlock<uchar>::MarkerIndex)
+		{
+			uchar lengthBytes[StoredBlock<uchar>::ExtraBytesCount];
+			for (short j = 0; j < StoredBlock<uchar>::ExtraBytesCount; j++)
+			{
+				lengthBytes[j] = (uchar)reader.Read(8);
+				restored.Write(lengthBytes[j], 8);
+			}
+			restoredBits += 8 * StoredBlock<uchar>::ExtraBytesCount;
+			extraBytesCount = (long long)StoredBlock<uchar>::DecodeLength(lengthBytes) * symbolWidth;
+
+			//raw symbols are in the coded block, so it can't be shorter
+			if (8 * extraBytesCount > availableBits)
+			{
+				fprintf(stderr, "FATAL:\tEntropy coded stored block is longer than its data\n");
+				exit(1);
+			}
+		}
+		else
+		{
+			end = true;
+			bitsInByteCount = matchIndex + 1;
+		}
+
+		for (long long j = 0; j < extraBytesCount; j++)
+		{
+			restored.Write(reader.Read(8), 8);
+		}
+		restoredBits += 8 * extraBytesCount;
+
+		if (matchIndex == StoredBlock<uchar>::MarkerIndex)
+			break;
+	}
+
+	return restoredBits;
+}
+
+void EntropyCoder::EncodeBlock(const uchar * bytes, long long start, long long end, ofstream & output)
+{
+	bool dataEnd;
+	long long position = start;
+	while (position < end)
+	{
+		position += ScanGroup(bytes, position, end, CountScan, NULL, dataEnd);
+	}
+
+	literals.Build();
+	lengths.Build();
+	distances.Build();
+
+	vector<uchar> coded;
+	BitWriter writer(&coded);
+	literals.WriteLengths(writer);
+	lengths.WriteLengths(writer);
+	distances.WriteLengths(writer);
+
+	position = start;
+	while (position < end)
+	{
+		position += ScanGroup(bytes, position, end, EncodeScan, &writer, dataEnd);
+	}
+	writer.Flush();
+
+	uchar blockHeader[BlockHeaderSize];
+	long long blockBits = end - start;
+	long long codedCount = coded.size();
+	for (short i = 0; i < RestoredBitsBytes; i++)
+	{
+		blockHeader[i] = (blockBits >> ((RestoredBitsBytes - 1 - i) * 8)) & 0xff;
+	}
+	for (short i = 0; i < CodedBytesBytes; i++)
+	{
+		blockHeader[RestoredBitsBytes + i] = (codedCount >> ((CodedBytesBytes - 1 - i) * 8)) & 0xff;
+	}
+
+	output.write(reinterpret_cast<char *>(blockHeader), BlockHeaderSize);
+	output.write(reinterpret_cast<char *>(coded.data()), codedCount);
+	codedBytes += BlockHeaderSize + codedCount;
+}
+
+void EntropyCoder::CodeValue(HuffmanCode & code, short directBits, unsigned long long value, ScanEnum scan, BitWriter * writer)
+{
+	int symbol = (int)value;
+	short extraBits = 0;
+	if (value >= (1ULL << directBits))
+	{
+		//two symbols per binary order - by the bit below the highest one
+		short highestBit = directBits;
+		while (value >> (highestBit + 1))
+		{
+			highestBit++;
+		}
+
+		extraBits = highestBit - 1;
+		symbol = (1 << directBits) + ((highestBit - directBits) << 1) + (int)((value >> extraBits) & 1);
+	}
+
+	if (scan == CountScan)
+	{
+		code.Count(symbol);
+	}
+	else if (scan == EncodeScan)
+	{
+		code.Encode(*writer, symbol);
+		writer->Write(value & ((1ULL << extraBits) - 1), extraBits);
+	}
+}
+
+unsigned long long EntropyCoder::DecodeValue(HuffmanCode & code, short directBits, BitReader & reader)
+{
+	int symbol = code.Decode(reader);
+	if (symbol < (1 << directBits))
+		return symbol;
+
+	symbol -= 1 << directBits;
+	short extraBits = (symbol >> 1) + directBits - 1;
+	return ((2ULL | (symbol & 1)) << extraBits) | reader.Read(extraBits);
+}
+
+int EntropyCoder::AlphabetSize(short directBits)
+{
+	return (1 << directBits) + ((64 - directBits) << 1);
+}
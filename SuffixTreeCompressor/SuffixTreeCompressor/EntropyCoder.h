@@ -0,0 +1,169 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include "BitStream.h"
+#include "HuffmanCode.h"
+#include "Encoder.h"
+#include "Decoder.h"
+
+using namespace std;
+
+/**
+ * <summary> Entropy stage over the output of compression. The compressed bit stream is split into blocks of whole groups of
+ *  flags and every block gets its own Huffman codes for literals, match lengths and match distances (values of every
+ *  model are split into buckets - small values have their own symbol, bigger ones share it per half of binary order and
+ *  the rest of bits follows raw). Slots of repeat codes are coded as the smallest distances. Flags, markers and their
+ *  extra bytes are written raw. Decoding restores the original compressed data, so the decompressor is the same.</summary>
+ */
+
+class EntropyCoder
+{
+	public:
+		static const int BlockSize = 1 << 20;			///< Number of bytes of compressed data per block (it ends behind the group)
+		static const short RestoredBitsBytes = 5;		///< Bytes of the number of restored bits in block header
+		static const short CodedBytesBytes = 4;			///< Bytes of the number of coded bytes in block header
+		static const short LengthDirectBits = 6;		///< Match lengths below 2^LengthDirectBits have their own symbol
+		static const short DistanceDirectBits = 4;		///< Match distances below 2^DistanceDirectBits have their own symbol
+		static const short ByteLiteralDirectBits = 8;	///< Every byte literal has its own symbol
+		static const short TokenLiteralDirectBits = 11;	///< Token IDs below 2^TokenLiteralDirectBits have their own symbol
+		static const short MarkerBits = 4;				///< Bits of index of zero-length match (end of data, long-range reference, stored block)
+		static const int BlockHeaderSize = RestoredBitsBytes + CodedBytesBytes;	///< Bytes in front of block - bits of the restored data and bytes of the coded block
+		static const int DecodePaddingBytes = 256;		///< Readable bytes behind the coded block - more than any group except stored block takes
+
+		/**
+		 * <summary> Constructor.</summary>
+		 *
+		 * <param name="symbolWidth">	  Number of bytes of one symbol.</param>
+		 * <param name="windowBits">	  Sliding window size in bits.</param>
+		 * <param name="matchLengthBits"> Number of bits of match length.</param>
+		 * <param name="repeatCodes">	  Whether matches have flag bit of repeat code.</param>
+		 */
+
+		EntropyCoder(short symbolWidth, short windowBits, short matchLengthBits, bool repeatCodes);
+
+		/**
+		 * <summary> Replaces compressed file by its entropy coded version.</summary>
+		 *
+		 * <param name="fileName"> Filename of the compressed file.</param>
+		 */
+
+		void EncodeFile(const string& fileName);
+
+		/**
+		 * <summary> Restores compressed file from its entropy coded version - a frame of the file, so that entropy coded files
+		 *  can be merged into archive. The coded data have to end at the frame end.</summary>
+		 *
+		 * <param name="inFile">	  The entropy coded file.</param>
+		 * <param name="outFile">	  The restored compressed file.</param>
+		 * <param name="frameOffset"> Position of the frame (its header) in the file.</param>
+		 * <param name="frameEnd">	  Position behind the frame.</param>
+		 */
+
+		void DecodeFile(const string& inFile, const string& outFile, long long frameOffset, long long frameEnd);
+
+		long long GetRestoredBytes() const;
+		long long GetCodedBytes() const;
+
+	private:
+		enum ScanEnum { MeasureScan, CountScan, EncodeScan };	///< What is done with the items of scanned group
+
+		short symbolWidth;				///< Number of bytes of one symbol
+		short matchLengthBits;			///< Number of bits of match length
+		short matchBits;				///< Number of bits per one match (index and length, without flag bit of repeat code)
+		bool repeatCodes;				///< Whether matches have flag bit of repeat code
+		short distanceBias;				///< Added to distances of full match codes - smaller values are slots of repeat codes
+		int bufferSize;					///< Size of the buffer (twice the window size) - match indices are below it
+		short literalDirectBits;		///< Literals below 2^literalDirectBits have their own symbol
+		Encoder encoder;				///< The encoder for restored matches
+		Decoder decoder;				///< The decoder for scanned matches
+		HuffmanCode literals;			///< Code of literals
+		HuffmanCode lengths;			///< Code of match lengths (zero for markers)
+		HuffmanCode distances;			///< Code of match distances
+		long long restoredBytes;		///< Number of bytes of compressed data
+		long long codedBytes;			///< Number of bytes of the entropy coded data
+
+		/**
+		 * <summary> Scans one group of flags of compressed data.</summary>
+		 *
+		 * <param name="bytes">			The compressed data (followed by BitReader::PaddingBytes).</param>
+		 * <param name="position">		Position of the first bit of the group (the flags byte).</param>
+		 * <param name="availableBits"> Number of bits of the data.</param>
+		 * <param name="scan">			What is done with the items.</param>
+		 * <param name="writer">		The writer (EncodeScan).</param>
+		 * <param name="end">			Set if the group holds the end of data.</param>
+		 *
+		 * <returns> Number of bits of the group, -1 if the data end inside it.</returns>
+		 */
+
+		long long ScanGroup(const uchar * bytes, long long position, long long availableBits, ScanEnum scan, BitWriter * writer, bool & end);
+
+		/**
+		 * <summary> Restores one group of flags of compressed data.</summary>
+		 *
+		 * <param name="reader">		The reader.</param>
+		 * <param name="restored">		The writer of the restored data.</param>
+		 * <param name="availableBits"> Number of coded bits that are left - stored block can't be longer.</param>
+		 * <param name="end">			Set if the group holds the end of data.</param>
+		 *
+		 * <returns> Number of bits of the restored group.</returns>
+		 */
+
+		long long DecodeGroup(BitReader & reader, BitWriter & restored, long long availableBits, bool & end);
+
+		/**
+		 * <summary> Codes block of whole groups and writes it out.</summary>
+		 *
+		 * <param name="bytes">	   The compressed data.</param>
+		 * <param name="start">	   Position of the first bit of the block.</param>
+		 * <param name="end">	   Position behind the last bit of the block.</param>
+		 * <param name="output">  The output.</param>
+		 */
+
+		void EncodeBlock(const uchar * bytes, long long start, long long end, ofstream & output);
+
+		/**
+		 * <summary> Counts or writes value by the model.</summary>
+		 *
+		 * <param name="code">		 The code of the model.</param>
+		 * <param name="directBits"> Values below 2^directBits have their own symbol.</param>
+		 * <param name="value">		 The value.</param>
+		 * <param name="scan">		 What is done with the value.</param>
+		 * <param name="writer">	 The writer (EncodeScan).</param>
+		 */
+
+		void CodeValue(HuffmanCode & code, short directBits, unsigned long long value, ScanEnum scan, BitWriter * writer);
+
+		/**
+		 * <summary> Reads value by the model.</summary>
+		 *
+		 * <param name="code">		 The code of the model.</param>
+		 * <param name="directBits"> Values below 2^directBits have their own symbol.</param>
+		 * <param name="reader">	 The reader.</param>
+		 *
+		 * <returns> The value.</returns>
+		 */
+
+		unsigned long long DecodeValue(HuffmanCode & code, short directBits, BitReader & reader);
+
+		/**
+		 * <summary> Gets number of symbols of model.</summary>
+		 *
+		 * <param name="directBits"> Values below 2^directBits have their own symbol.</param>
+		 *
+		 * <returns> The alphabet size.</returns>
+		 */
+
+		static int AlphabetSize(short directBits);
+};
+
+
+inline long long EntropyCoder::GetRestoredBytes() const
+{
+	return restoredBytes;
+}
+
+inline long long EntropyCoder::GetCodedBytes() const
+{
+	return codedBytes;
+}
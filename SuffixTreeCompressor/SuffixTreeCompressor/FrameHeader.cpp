@@ -0,0 +1,84 @@
+#include "FrameHeader.h"
+#include <fstream>
+#include <stdio.h>
+#include <stdlib.h>
+
+FrameHeader::FrameHeader()
+{
+	this->WindowBits = 0;
+	this->MatchLengthBits = 0;
+	this->SymbolWidth = 0;
+	this->Tokenizer = ByteTokenizer;
+	this->Flags = 0;
+	this->BlockSize = 0;
+}
+
+void FrameHeader::Encode(uchar * bytes) const
+{
+	for (short i = 0; i < 4; i++)
+	{
+		bytes[i] = (Magic >> (i * 8)) & 0xff;
+	}
+
+	bytes[4] = Version;
+	bytes[5] = (uchar)WindowBits;
+	bytes[6] = (uchar)MatchLengthBits;
+	bytes[7] = (uchar)SymbolWidth;
+	bytes[8] = (uchar)Tokenizer;
+	bytes[9] = Flags & 0xff;
+	bytes[10] = Flags >> 8;
+	bytes[11] = 0;
+
+	for (short i = 0; i < 4; i++)
+	{
+		bytes[12 + i] = (BlockSize >> ((3 - i) * 8)) & 0xff;
+	}
+}
+
+FrameHeader FrameHeader::Read(const string& fileName, long long offset)
+{
+	uchar bytes[Size];
+	ifstream input(fileName, ios::in | ios::binary);
+	input.seekg(offset);
+	input.read(reinterpret_cast<char *>(bytes), Size);
+
+	unsigned int magic = 0;
+	for (short i = 0; i < 4; i++)
+	{
+		magic |= (unsigned int)bytes[i] << (i * 8);
+	}
+
+	if (input.fail() || magic != Magic)
+	{
+		fprintf(stderr, "FATAL:\t\"%s\" is not a compressed file\n", fileName.c_str());
+		exit(1);
+	}
+
+	if (bytes[4] != Version)
+	{
+		fprintf(stderr, "FATAL:\t\"%s\" has unknown format version %d\n", fileName.c_str(), bytes[4]);
+		exit(1);
+	}
+
+	FrameHeader header;
+	header.WindowBits = bytes[5];
+	header.MatchLengthBits = bytes[6];
+	header.SymbolWidth = bytes[7];
+	header.Tokenizer = (TokenizerEnum)bytes[8];
+	header.Flags = bytes[9] | (bytes[10] << 8);
+	header.BlockSize = 0;
+	for (short i = 0; i < 4; i++)
+	{
+		header.BlockSize = (header.BlockSize << 8) | bytes[12 + i];
+	}
+
+	//only values that the compressor writes
+	bool validWidth = header.SymbolWidth == 1 || header.SymbolWidth == 2 || header.SymbolWidth == 4 || header.SymbolWidth == 8;
+	if (header.WindowBits < 2 || header.WindowBits > 29 || header.MatchLengthBits < 1 || header.MatchLengthBits > 16 || !validWidth || header.Tokenizer > WordTokenizer)
+	{
+		fprintf(stderr, "FATAL:\t\"%s\" has invalid header\n", fileName.c_str());
+		exit(1);
+	}
+
+	return header;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include "Tokenizer.h"
+
+using namespace std;
+
+typedef unsigned char uchar;
+
+/**
+ * <summary> Header at the start of every compressed file. It describes all parameters the decoder needs, so it configures
+ *  itself from the file instead of command line options.</summary>
+ */
+
+class FrameHeader
+{
+	public:
+		static const unsigned int Magic = 0x46435453;	///< "STCF" - the first bytes of compressed file
+		static const uchar Version = 7;					///< Version of the format (2 - items packed to bits, 3 - extended match lengths, 4 - repeat codes, 5 - sequence layout, 6 - split layout, 7 - checksums)
+		static const int Size = 16;						///< Number of bytes of the header
+
+		static const unsigned short LongRangeFlag = 0x01;		///< The file contains long-range references
+		static const unsigned short ReferenceFlag = 0x02;		///< The file was compressed against a reference file
+		static const unsigned short ContinuationFlag = 0x04;	///< The file is continuation segment (resumed from checkpoint)
+		static const unsigned short IndexedFlag = 0x08;			///< The file has block index at the end (it is split into independent blocks or has checksums)
+		static const unsigned short EntropyFlag = 0x10;			///< The compressed data are entropy coded (EntropyCoder)
+		static const unsigned short RepeatFlag = 0x20;			///< Matches that reuse one of the last match indices have repeat codes
+		static const unsigned short SequenceFlag = 0x40;		///< Items are in sequence layout (literal run and match) instead of groups of flags
+		static const unsigned short SplitFlag = 0x80;			///< Items are in split layout (blocks of flags, literals and matches sub-streams)
+		static const unsigned short ChecksumFlag = 0x100;		///< Entries of the block index hold checksums of their blocks
+
+		short WindowBits;			///< Sliding window size in bits
+		short MatchLengthBits;		///< Number of bits of match length
+		short SymbolWidth;			///< Number of bytes of one symbol
+		TokenizerEnum Tokenizer;	///< The way the input was split into symbols
+		unsigned short Flags;		///< Combination of the flags above
+		int BlockSize;				///< Number of symbols per block of the engine (0 - online suffix tree)
+
+		FrameHeader();
+
+		/**
+		 * <summary> Encodes the header.</summary>
+		 *
+		 * <param name="bytes"> The bytes (Size).</param>
+		 */
+
+		void Encode(uchar * bytes) const;
+
+		/**
+		 * <summary> Reads the header from the start of compressed file - it is fatal if the file has no valid header.</summary>
+		 *
+		 * <param name="fileName"> Filename of the compressed file.</param>
+		 * <param name="offset">   Position of the header (start of frame of archive).</param>
+		 *
+		 * <returns> The header.</returns>
+		 */
+
+		static FrameHeader Read(const string& fileName, long long offset = 0);
+};
@@ -0,0 +1,220 @@
+#include "FrameIndex.h"
+#include "FrameHeader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+void FrameIndex::Add(const FrameIndexEntry& entry)
+{
+	entries.push_back(entry);
+}
+
+void FrameIndex::Encode(vector<uchar>& bytes) const
+{
+	for (const FrameIndexEntry& entry : entries)
+	{
+		long long values[3] = { entry.CompressedOffset, entry.CompressedSize, entry.DictionaryOffset };
+		for (short i = 0; i < 3; i++)
+		{
+			for (short j = 7; j >= 0; j--)
+			{
+				bytes.push_back((values[i] >> (j * 8)) & 0xff);
+			}
+		}
+	}
+
+	int count = entries.size();
+	for (short j = 3; j >= 0; j--)
+	{
+		bytes.push_back((count >> (j * 8)) & 0xff);
+	}
+
+	for (short j = 0; j < 4; j++)
+	{
+		bytes.push_back((Magic >> (j * 8)) & 0xff);
+	}
+}
+
+bool FrameIndex::Read(const string& fileName)
+{
+	entries.clear();
+
+	ifstream input(fileName, ios::in | ios::binary | ios::ate);
+	long long fileSize = (long long)input.tellg();
+	if (fileSize < TrailerSize)
+		return false;
+
+	uchar trailer[TrailerSize];
+	input.seekg(fileSize - TrailerSize);
+	input.read(reinterpret_cast<char *>(trailer), TrailerSize);
+
+	int count = 0;
+	unsigned int magic = 0;
+	for (short j = 0; j < 4; j++)
+	{
+		count = (count << 8) | trailer[j];
+		magic |= (unsigned int)trailer[4 + j] << (j * 8);
+	}
+
+	if (input.fail() || magic != Magic || count <= 0 || (long long)count * EntrySize > fileSize - TrailerSize)
+		return false;
+
+	long long indexStart = fileSize - TrailerSize - (long long)count * EntrySize;
+	vector<uchar> bytes((size_t)count * EntrySize);
+	input.seekg(indexStart);
+	input.read(reinterpret_cast<char *>(bytes.data()), bytes.size());
+
+	entries.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		unsigned long long values[3] = { 0, 0, 0 };
+		for (short j = 0; j < 3; j++)
+		{
+			for (short k = 0; k < 8; k++)
+			{
+				values[j] = (values[j] << 8) | bytes[i * EntrySize + j * 8 + k];
+			}
+		}
+
+		entries[i].CompressedOffset = (long long)values[0];
+		entries[i].CompressedSize = (long long)values[1];
+		entries[i].DictionaryOffset = (long long)values[2];
+	}
+
+	//compressed data may end with the magic by chance - frames of archive cover it up to the index
+	long long position = 0;
+	for (const FrameIndexEntry& entry : entries)
+	{
+		if (entry.CompressedOffset != position || entry.CompressedSize < FrameHeader::Size)
+			break;
+
+		position += entry.CompressedSize;
+	}
+
+	if (input.fail() || position != indexStart)
+	{
+		entries.clear();
+		return false;
+	}
+
+	return true;
+}
+
+void FrameIndex::Concatenate(const vector<string>& inputFiles, const string& outputFile)
+{
+	ofstream output(outputFile, ios::out | ios::binary | ios::trunc);
+	if (output.fail())
+	{
+		fprintf(stderr, "FATAL:\tCan't open file \"%s\"\n", outputFile.c_str());
+		exit(1);
+	}
+
+	ofstream dictionary;
+	long long outputBytes = 0;
+	long long dictionaryBytes = 0;
+
+	for (const string& inputFile : inputFiles)
+	{
+		if (inputFile == outputFile)
+		{
+			fprintf(stderr, "FATAL:\t\"%s\" can't be merged into itself\n", inputFile.c_str());
+			exit(1);
+		}
+
+		//compressed file is one frame, archive brings all its frames
+		FrameIndex frames;
+		if (!frames.Read(inputFile))
+		{
+			FrameHeader header = FrameHeader::Read(inputFile);
+
+			//continuation segment is decoded by window of the file before it
+			if (header.Flags & FrameHeader::ContinuationFlag)
+			{
+				fprintf(stderr, "FATAL:\t\"%s\" is continuation segment - it can't be merged\n", inputFile.c_str());
+				exit(1);
+			}
+
+			ifstream input(inputFile, ios::in | ios::binary | ios::ate);
+			FrameIndexEntry entry;
+			entry.CompressedOffset = 0;
+			entry.CompressedSize = (long long)input.tellg();
+			entry.DictionaryOffset = (header.Tokenizer == ByteTokenizer) ? NoDictionary : 0;
+			frames.Add(entry);
+		}
+
+		AppendFile(inputFile, frames.GetFramesEnd(), output);
+
+		bool tokens = false;
+		for (const FrameIndexEntry& entry : frames.entries)
+		{
+			tokens = tokens || entry.DictionaryOffset != NoDictionary;
+		}
+
+		long long inputDictionaryBytes = 0;
+		if (tokens)
+		{
+			string dictionaryFile = DictionaryFile(inputFile);
+			ifstream inputDictionary(dictionaryFile, ios::in | ios::binary | ios::ate);
+			if (inputDictionary.fail())
+			{
+				fprintf(stderr, "FATAL:\tDictionary \"%s\" of \"%s\" is missing\n", dictionaryFile.c_str(), inputFile.c_str());
+				exit(1);
+			}
+			inputDictionaryBytes = (long long)inputDictionary.tellg();
+			inputDictionary.close();
+
+			if (!dictionary.is_open())
+			{
+				dictionary.open(DictionaryFile(outputFile), ios::out | ios::binary | ios::trunc);
+			}
+			AppendFile(dictionaryFile, inputDictionaryBytes, dictionary);
+		}
+
+		for (FrameIndexEntry entry : frames.entries)
+		{
+			entry.CompressedOffset += outputBytes;
+			if (entry.DictionaryOffset != NoDictionary)
+			{
+				entry.DictionaryOffset += dictionaryBytes;
+			}
+			Add(entry);
+		}
+
+		outputBytes += frames.GetFramesEnd();
+		dictionaryBytes += inputDictionaryBytes;
+	}
+
+	vector<uchar> indexBytes;
+	Encode(indexBytes);
+	output.write(reinterpret_cast<const char *>(indexBytes.data()), indexBytes.size());
+	output.close();
+
+	if (output.fail() || (dictionary.is_open() && dictionary.fail()))
+	{
+		fprintf(stderr, "FATAL:\tCan't write archive \"%s\"\n", outputFile.c_str());
+		exit(1);
+	}
+}
+
+string FrameIndex::DictionaryFile(const string& compressedFile)
+{
+	return compressedFile.substr(0, compressedFile.length() - 4) + ".dat";
+}
+
+void FrameIndex::AppendFile(const string& fileName, long long length, ofstream& output)
+{
+	ifstream input(fileName, ios::in | ios::binary);
+	vector<char> part(CopiedPartSize);
+	for (long long position = 0; position < length; position += CopiedPartSize)
+	{
+		int partSize = (int)min((long long)CopiedPartSize, length - position);
+		input.read(part.data(), partSize);
+		if (input.gcount() != partSize)
+		{
+			fprintf(stderr, "FATAL:\tCan't read \"%s\"\n", fileName.c_str());
+			exit(1);
+		}
+
+		output.write(part.data(), partSize);
+	}
+}
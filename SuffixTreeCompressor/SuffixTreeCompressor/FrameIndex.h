@@ -0,0 +1,118 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+
+using namespace std;
+
+typedef unsigned char uchar;
+
+/**
+ * <summary> A struct to save where one frame of archive is.</summary>
+ */
+
+struct FrameIndexEntry
+{
+	public:
+		long long CompressedOffset;		///< Position of the first byte of the frame (its header) in the archive
+		long long CompressedSize;		///< Number of bytes of the frame with its block index
+		long long DictionaryOffset;		///< Position of the token dictionary of the frame in dictionary of the archive (NoDictionary in byte mode)
+};
+
+/**
+ * <summary> Index of frames of archive. Compressed files are merged without recompression - their bytes are copied one
+ *  behind another and the index follows them. Every frame keeps its own header, block index and token dictionary (the
+ *  dictionaries are copied one behind another into dictionary of the archive), so it is decoded the same way as the file
+ *  it was copied from. The index is followed by number of frames and Magic.</summary>
+ */
+
+class FrameIndex
+{
+	public:
+		static const unsigned int Magic = 0x41435453;	///< "STCA" - the last bytes of archive
+		static const int EntrySize = 24;				///< Number of bytes of one entry
+		static const int TrailerSize = 8;				///< Number of bytes behind the entries - count of frames and magic
+		static const long long NoDictionary = -1;		///< Dictionary offset of frame in byte mode
+
+		/**
+		 * <summary> Adds frame to the index.</summary>
+		 *
+		 * <param name="entry"> The entry.</param>
+		 */
+
+		void Add(const FrameIndexEntry& entry);
+
+		/**
+		 * <summary> Encodes the index with its trailer.</summary>
+		 *
+		 * <param name="bytes"> The bytes.</param>
+		 */
+
+		void Encode(vector<uchar>& bytes) const;
+
+		/**
+		 * <summary> Reads the index from the end of compressed file. Frames have to cover the file up to the index.</summary>
+		 *
+		 * <param name="fileName"> Filename of the compressed file.</param>
+		 *
+		 * <returns> True if the file is archive, false if it is one compressed file.</returns>
+		 */
+
+		bool Read(const string& fileName);
+
+		/**
+		 * <summary> Merges compressed files into archive - their frames are copied and the frames of archives are added with
+		 *  their positions in the new one. Token dictionary of every file is expected where decompression of file.xxx into
+		 *  file.yyy looks for it (file.dat) and dictionary of the archive is written the same way.</summary>
+		 *
+		 * <param name="inputFiles"> Filenames of the compressed files or archives.</param>
+		 * <param name="outputFile"> Filename of the archive.</param>
+		 */
+
+		void Concatenate(const vector<string>& inputFiles, const string& outputFile);
+
+		/**
+		 * <summary> Gets filename of token dictionary of compressed file - the extension is replaced.</summary>
+		 *
+		 * <param name="compressedFile"> Filename of the compressed file.</param>
+		 *
+		 * <returns> Filename of the dictionary.</returns>
+		 */
+
+		static string DictionaryFile(const string& compressedFile);
+
+		int GetCount() const;
+		const FrameIndexEntry& Get(int frame) const;
+		long long GetFramesEnd() const;
+
+	private:
+		static const int CopiedPartSize = 1 << 20;	///< Number of bytes that are copied at once
+
+		vector<FrameIndexEntry> entries;	///< Frames ordered by position
+
+		/**
+		 * <summary> Appends beginning of file to output.</summary>
+		 *
+		 * <param name="fileName"> Filename of the copied file.</param>
+		 * <param name="length">   Number of bytes to copy.</param>
+		 * <param name="output">   The output.</param>
+		 */
+
+		static void AppendFile(const string& fileName, long long length, ofstream& output);
+};
+
+
+inline int FrameIndex::GetCount() const
+{
+	return entries.size();
+}
+
+inline const FrameIndexEntry& FrameIndex::Get(int frame) const
+{
+	return entries[frame];
+}
+
+inline long long FrameIndex::GetFramesEnd() const
+{
+	return entries.empty() ? 0 : entries.back().CompressedOffset + entries.back().CompressedSize;
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <ctype.h>
+#include "MatchFinder.hh"
+
+/**
+ * <summary> Fast block match finder. Positions are chained by hash of their first HashLength symbols and only a bounded
+ *  number of the most recent candidates is checked, so the longest match may be missed. Sparse finder indexes and searches
+ *  only positions where a word or a run of other symbols starts (symbols are expected to be bytes) - the match found there
+ *  is passed on to the following positions, so matches stay symbol-exact.</summary>
+ */
+
+ //Declaration----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+class HashChainMatchFinder : public MatchFinder<T>
+{
+	public:
+		static const int HashLength = 3;	///< Number of symbols that are hashed - shorter matches are not found
+
+		HashChainMatchFinder(int capacity, int chainDepth, int niceLength, bool sparse);
+		~HashChainMatchFinder();
+
+		void FindMatches(const T * symbols, int historyLength, int length, int * matchLengths, int * matchDistances);
+
+	private:
+		int capacity;		///< Maximal number of symbols (history and block) in one call
+		int chainDepth;		///< Maximal number of candidates checked per position
+		int niceLength;		///< Match that is long enough - searching stops when it is found
+		bool sparse;		///< Whether only word boundaries are indexed
+		short hashBits;		///< Number of bits of hash
+		int * head;			///< The most recent position for every hash (-1 if none)
+		int * previous;		///< Previous position with the same hash for every position (-1 if none)
+
+		/**
+		 * <summary> Computes hash of HashLength symbols.</summary>
+		 *
+		 * <param name="symbols"> The first symbol.</param>
+		 *
+		 * <returns> The hash.</returns>
+		 */
+
+		int Hash(const T * symbols);
+
+		/**
+		 * <summary> Inserts position into its hash chain.</summary>
+		 *
+		 * <param name="symbols">  The symbols.</param>
+		 * <param name="position"> The position.</param>
+		 */
+
+		void Insert(const T * symbols, int position);
+
+		/**
+		 * <summary> Checks whether position is indexed - all are, unless the finder is sparse.</summary>
+		 *
+		 * <param name="symbols">  The symbols.</param>
+		 * <param name="position"> The position.</param>
+		 *
+		 * <returns> True if a word or a run of non-word symbols starts at the position.</returns>
+		 */
+
+		bool IsIndexed(const T * symbols, int position);
+};
+
+//Definition----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+HashChainMatchFinder<T>::HashChainMatchFinder(int capacity, int chainDepth, int niceLength, bool sparse)
+{
+	this->capacity = capacity;
+	this->chainDepth = chainDepth;
+	this->niceLength = niceLength;
+	this->sparse = sparse;
+
+	//about one chain per position, but keep the table in cache-friendly range
+	this->hashBits = 10;
+	while (hashBits < 20 && (1 << hashBits) < capacity)
+	{
+		hashBits++;
+	}
+
+	this->head = new int[1 << hashBits];
+	this->previous = new int[capacity];
+}
+
+template <typename T>
+HashChainMatchFinder<T>::~HashChainMatchFinder()
+{
+	delete[] head;
+	delete[] previous;
+}
+
+template <typename T>
+void HashChainMatchFinder<T>::FindMatches(const T * symbols, int historyLength, int length, int * matchLengths, int * matchDistances)
+{
+	for (int i = 0; i < (1 << hashBits); i++)
+	{
+		head[i] = -1;
+	}
+
+	//history was shifted in front of the block - chains are built again
+	for (int position = 0; position < historyLength && position + HashLength <= length; position++)
+	{
+		if (IsIndexed(symbols, position))
+		{
+			Insert(symbols, position);
+		}
+	}
+
+	for (int position = historyLength; position < length; position++)
+	{
+		int bestLength = 0;
+		int bestDistance = 0;
+		int maxLength = length - position;
+		if (maxLength > niceLength) maxLength = niceLength;
+
+		//rest of the match from the previous position, extended if it was cut by the nice length
+		if (sparse && position > historyLength && matchLengths[position - historyLength - 1] > 1)
+		{
+			bestLength = matchLengths[position - historyLength - 1] - 1;
+			bestDistance = matchDistances[position - historyLength - 1];
+			while (bestLength < maxLength && symbols[position - bestDistance + bestLength] == symbols[position + bestLength])
+			{
+				bestLength++;
+			}
+		}
+
+		if (IsIndexed(symbols, position) && position + HashLength <= length)
+		{
+			int candidate = head[Hash(symbols + position)];
+			for (int depth = 0; candidate >= 0 && depth < chainDepth && bestLength < maxLength; depth++)
+			{
+				int matchLength = 0;
+				while (matchLength < maxLength && symbols[candidate + matchLength] == symbols[position + matchLength])
+				{
+					matchLength++;
+				}
+
+				if (matchLength > bestLength)
+				{
+					bestLength = matchLength;
+					bestDistance = position - candidate;
+
+					if (matchLength == maxLength)
+						break;
+				}
+
+				candidate = previous[candidate];
+			}
+
+			Insert(symbols, position);
+		}
+
+		matchLengths[position - historyLength] = bestLength;
+		matchDistances[position - historyLength] = bestDistance;
+	}
+}
+
+template <typename T>
+inline int HashChainMatchFinder<T>::Hash(const T * symbols)
+{
+	unsigned long long hash = 0;
+	for (int i = 0; i < HashLength; i++)
+	{
+		hash = hash * 0x9E3779B1ULL + (unsigned long long)symbols[i];
+	}
+
+	return (int)((hash * 0x9E3779B97F4A7C15ULL) >> (64 - hashBits));
+}
+
+template <typename T>
+inline bool HashChainMatchFinder<T>::IsIndexed(const T * symbols, int position)
+{
+	if (!sparse || position == 0)
+		return true;
+
+	bool isWord = symbols[position] <= 0x7f && isalnum((int)symbols[position]);
+	bool previousIsWord = symbols[position - 1] <= 0x7f && isalnum((int)symbols[position - 1]);
+
+	return isWord != previousIsWord;
+}
+
+template <typename T>
+inline void HashChainMatchFinder<T>::Insert(const T * symbols, int position)
+{
+	int hash = Hash(symbols + position);
+	previous[position] = head[hash];
+	head[hash] = position;
+}
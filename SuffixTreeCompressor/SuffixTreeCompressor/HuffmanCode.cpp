@@ -0,0 +1,179 @@
+#include "HuffmanCode.h"
+#include <queue>
+#include <functional>
+#include <stdio.h>
+#include <stdlib.h>
+
+HuffmanCode::HuffmanCode(int alphabetSize)
+{
+	this->alphabetSize = alphabetSize;
+	this->counts.assign(alphabetSize, 0);
+	this->lengths.assign(alphabetSize, 0);
+	this->codes.assign(alphabetSize, 0);
+}
+
+void HuffmanCode::Build()
+{
+	//flatter counts give shorter longest code, so they are halved until the code fits
+	vector<long long> scaledCounts = counts;
+	while (ComputeLengths(scaledCounts) > MaxCodeLength)
+	{
+		for (long long & count : scaledCounts)
+		{
+			if (count > 0)
+				count = (count >> 1) | 1;
+		}
+	}
+
+	AssignCodes();
+	counts.assign(alphabetSize, 0);
+}
+
+void HuffmanCode::WriteLengths(BitWriter & writer)
+{
+	//most symbols of big alphabets are unused, so runs of zero lengths are shortened
+	for (int i = 0; i < alphabetSize; i++)
+	{
+		int run = 0;
+		while (i + run < alphabetSize && lengths[i + run] == 0 && run < (1 << ZeroRunBits))
+		{
+			run++;
+		}
+
+		if (run >= MinZeroRun)
+		{
+			writer.Write(ZeroRunCode, CodeLengthBits);
+			writer.Write(run - 1, ZeroRunBits);
+			i += run - 1;
+		}
+		else
+			writer.Write(lengths[i], CodeLengthBits);
+	}
+}
+
+void HuffmanCode::ReadLengths(BitReader & reader)
+{
+	for (int i = 0; i < alphabetSize; i++)
+	{
+		lengths[i] = (uchar)reader.Read(CodeLengthBits);
+		if (lengths[i] != ZeroRunCode)
+			continue;
+
+		int run = (int)reader.Read(ZeroRunBits) + 1;
+		for (int j = 0; j < run && i < alphabetSize; j++)
+		{
+			lengths[i++] = 0;
+		}
+		i--;
+	}
+
+	if (!AssignCodes())
+	{
+		fprintf(stderr, "FATAL:\tInvalid Huffman code in compressed file\n");
+		exit(1);
+	}
+
+	//codes don't have to be complete (one used symbol), bits out of the code are never looked up in valid data
+	tableSymbols.assign(1 << MaxCodeLength, 0);
+	tableLengths.assign(1 << MaxCodeLength, 0);
+	for (int i = 0; i < alphabetSize; i++)
+	{
+		if (lengths[i] == 0)
+			continue;
+
+		int first = codes[i] << (MaxCodeLength - lengths[i]);
+		int count = 1 << (MaxCodeLength - lengths[i]);
+		for (int j = first; j < first + count; j++)
+		{
+			tableSymbols[j] = (unsigned short)i;
+			tableLengths[j] = lengths[i];
+		}
+	}
+}
+
+int HuffmanCode::ComputeLengths(const vector<long long> & counts)
+{
+	//leaves are 0 .. alphabetSize - 1, inner vertices follow
+	vector<int> parents(2 * alphabetSize, -1);
+	priority_queue<pair<long long, int>, vector<pair<long long, int>>, greater<pair<long long, int>>> queue;
+	for (int i = 0; i < alphabetSize; i++)
+	{
+		lengths[i] = 0;
+		if (counts[i] > 0)
+			queue.push(make_pair(counts[i], i));
+	}
+
+	//the only symbol still needs one bit
+	if (queue.size() == 1)
+	{
+		lengths[queue.top().second] = 1;
+		return 1;
+	}
+
+	int nextVertex = alphabetSize;
+	while (queue.size() > 1)
+	{
+		pair<long long, int> first = queue.top();
+		queue.pop();
+		pair<long long, int> second = queue.top();
+		queue.pop();
+
+		parents[first.second] = parents[second.second] = nextVertex;
+		queue.push(make_pair(first.first + second.first, nextVertex++));
+	}
+
+	//parents are created after their children, so depths are known going from the root down
+	vector<int> depths(nextVertex, 0);
+	for (int i = nextVertex - 2; i >= 0; i--)
+	{
+		if (parents[i] >= 0)
+			depths[i] = depths[parents[i]] + 1;
+	}
+
+	int longest = 0;
+	for (int i = 0; i < alphabetSize; i++)
+	{
+		if (counts[i] > 0)
+		{
+			lengths[i] = depths[i] > 255 ? 255 : (uchar)depths[i];
+			longest = (depths[i] > longest) ? depths[i] : longest;
+		}
+	}
+
+	return longest;
+}
+
+bool HuffmanCode::AssignCodes()
+{
+	int lengthCounts[MaxCodeLength + 1] = { 0 };
+	for (int i = 0; i < alphabetSize; i++)
+	{
+		if (lengths[i] > MaxCodeLength)
+			return false;
+
+		lengthCounts[lengths[i]]++;
+	}
+
+	//canonical code - shorter codes first, symbols of the same length in order
+	unsigned int nextCodes[MaxCodeLength + 1] = { 0 };
+	unsigned int code = 0;
+	long long space = 0;
+	lengthCounts[0] = 0;
+	for (short length = 1; length <= MaxCodeLength; length++)
+	{
+		code = (code + lengthCounts[length - 1]) << 1;
+		nextCodes[length] = code;
+		space += (long long)lengthCounts[length] << (MaxCodeLength - length);
+	}
+
+	if (space > (1LL << MaxCodeLength))
+		return false;
+
+	for (int i = 0; i < alphabetSize; i++)
+	{
+		if (lengths[i] > 0)
+			codes[i] = nextCodes[lengths[i]]++;
+	}
+
+	return true;
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <vector>
+#include "BitStream.h"
+
+using namespace std;
+
+/**
+ * <summary> Canonical Huffman code of one alphabet with limited code length. Code lengths are sent in front of the coded
+ *  data, codes are derived from them. Decoding looks up the next MaxCodeLength bits in a table, so every symbol takes one
+ *  lookup.</summary>
+ */
+
+class HuffmanCode
+{
+	public:
+		static const short MaxCodeLength = 12;			///< The longest code (the decoding table has 2^MaxCodeLength entries)
+		static const short CodeLengthBits = 4;			///< Bits per code length in the table
+		static const uchar ZeroRunCode = 15;			///< Code length value that stands for run of unused symbols
+		static const short ZeroRunBits = 8;				///< Bits of length of the run (minus one)
+		static const int MinZeroRun = 3;				///< The shortest run written as ZeroRunCode
+
+		/**
+		 * <summary> Constructor.</summary>
+		 *
+		 * <param name="alphabetSize"> Number of symbols (at most 2^MaxCodeLength).</param>
+		 */
+
+		HuffmanCode(int alphabetSize);
+
+		/**
+		 * <summary> Counts the symbol for the next code.</summary>
+		 *
+		 * <param name="symbol"> The symbol.</param>
+		 */
+
+		void Count(int symbol);
+
+		/**
+		 * <summary> Builds code from the counted symbols and resets the counts.</summary>
+		 */
+
+		void Build();
+
+		/**
+		 * <summary> Writes code lengths.</summary>
+		 *
+		 * <param name="writer"> The writer.</param>
+		 */
+
+		void WriteLengths(BitWriter & writer);
+
+		/**
+		 * <summary> Reads code lengths and builds the decoding table - it is fatal if they don't form a code.</summary>
+		 *
+		 * <param name="reader"> The reader.</param>
+		 */
+
+		void ReadLengths(BitReader & reader);
+
+		/**
+		 * <summary> Writes code of the symbol.</summary>
+		 *
+		 * <param name="writer"> The writer.</param>
+		 * <param name="symbol"> The symbol.</param>
+		 */
+
+		void Encode(BitWriter & writer, int symbol);
+
+		/**
+		 * <summary> Reads the next symbol.</summary>
+		 *
+		 * <param name="reader"> The reader.</param>
+		 *
+		 * <returns> The symbol.</returns>
+		 */
+
+		int Decode(BitReader & reader);
+
+	private:
+		int alphabetSize;					///< Number of symbols
+		vector<long long> counts;			///< Occurrences of symbols since the last build
+		vector<uchar> lengths;				///< Code length of every symbol (zero if unused)
+		vector<unsigned int> codes;			///< Code of every symbol
+		vector<unsigned short> tableSymbols;	///< Symbol for every MaxCodeLength bits that start with its code
+		vector<uchar> tableLengths;			///< Length of the code for every MaxCodeLength bits
+
+		/**
+		 * <summary> Computes Huffman code lengths of the counts - they may be longer than MaxCodeLength.</summary>
+		 *
+		 * <param name="counts"> The counts.</param>
+		 *
+		 * <returns> The longest code.</returns>
+		 */
+
+		int ComputeLengths(const vector<long long> & counts);
+
+		/**
+		 * <summary> Assigns canonical codes to the lengths.</summary>
+		 *
+		 * <returns> False if the lengths don't form a complete code.</returns>
+		 */
+
+		bool AssignCodes();
+};
+
+
+inline void HuffmanCode::Count(int symbol)
+{
+	counts[symbol]++;
+}
+
+inline void HuffmanCode::Encode(BitWriter & writer, int symbol)
+{
+	writer.Write(codes[symbol], lengths[symbol]);
+}
+
+inline int HuffmanCode::Decode(BitReader & reader)
+{
+	unsigned int bits = (unsigned int)reader.Peek(MaxCodeLength);
+	reader.Skip(tableLengths[bits]);
+	return tableSymbols[bits];
+}
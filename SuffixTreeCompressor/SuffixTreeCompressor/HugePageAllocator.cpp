@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "HugePageAllocator.h"
+
+size_t HugePageAllocator::bytesAllocated = 0;
+size_t HugePageAllocator::bytesOnHugePages = 0;
+bool HugePageAllocator::explicitHugePages = false;
+
+#ifdef _WIN32
+/**
+ * <summary> Enables SeLockMemoryPrivilege that is needed for large pages (it has to be granted to the user).</summary>
+ *
+ * <returns> True if it succeeds, false if it fails.</returns>
+ */
+
+static bool EnableLockMemoryPrivilege()
+{
+	HANDLE token;
+	TOKEN_PRIVILEGES privileges;
+
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+		return false;
+
+	privileges.PrivilegeCount = 1;
+	privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+	bool enabled = LookupPrivilegeValue(NULL, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid)
+		&& AdjustTokenPrivileges(token, FALSE, &privileges, 0, NULL, NULL)
+		&& GetLastError() == ERROR_SUCCESS;
+
+	CloseHandle(token);
+	return enabled;
+}
+#endif
+
+void * HugePageAllocator::Allocate(size_t bytes)
+{
+	void * memory;
+	bytesAllocated += bytes;
+
+	//smaller arrays would waste most of the huge page
+	if (bytes < HugePageSize)
+	{
+		memory = malloc(bytes);
+		if (memory == NULL)
+		{
+			fprintf(stderr, "FATAL:\tCan't allocate %zu bytes\n", bytes);
+			exit(1);
+		}
+		return memory;
+	}
+
+	size_t size = RoundUp(bytes);
+
+#ifdef _WIN32
+	static bool privilegeEnabled = EnableLockMemoryPrivilege();
+	SIZE_T largePageSize = GetLargePageMinimum();
+
+	if (privilegeEnabled && largePageSize > 0 && size % largePageSize == 0)
+	{
+		memory = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (memory != NULL)
+		{
+			explicitHugePages = true;
+			bytesOnHugePages += bytes;
+			return memory;
+		}
+	}
+
+	memory = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	if (memory == NULL)
+	{
+		fprintf(stderr, "FATAL:\tCan't allocate %zu bytes\n", bytes);
+		exit(1);
+	}
+#else
+#ifdef MAP_HUGETLB
+	memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (memory != MAP_FAILED)
+	{
+		explicitHugePages = true;
+		bytesOnHugePages += bytes;
+		return memory;
+	}
+#endif
+
+	memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED)
+	{
+		fprintf(stderr, "FATAL:\tCan't allocate %zu bytes\n", bytes);
+		exit(1);
+	}
+
+#ifdef MADV_HUGEPAGE
+	//no reserved huge pages - at least ask for transparent ones
+	if (madvise(memory, size, MADV_HUGEPAGE) == 0)
+	{
+		bytesOnHugePages += bytes;
+	}
+#endif
+#endif
+
+	return memory;
+}
+
+void HugePageAllocator::Free(void * memory, size_t bytes)
+{
+	if (bytes < HugePageSize)
+	{
+		free(memory);
+		return;
+	}
+
+#ifdef _WIN32
+	VirtualFree(memory, 0, MEM_RELEASE);
+#else
+	munmap(memory, RoundUp(bytes));
+#endif
+}
+
+size_t HugePageAllocator::GetBytesAllocated()
+{
+	return bytesAllocated;
+}
+
+size_t HugePageAllocator::GetBytesOnHugePages()
+{
+	return bytesOnHugePages;
+}
+
+bool HugePageAllocator::ExplicitHugePagesObtained()
+{
+	return explicitHugePages;
+}
+
+size_t HugePageAllocator::RoundUp(size_t bytes)
+{
+	return (bytes + HugePageSize - 1) / HugePageSize * HugePageSize;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <stddef.h>
+#include <new>
+
+/**
+ * <summary> Allocator for big randomly accessed arrays (leaves, vertices, sliding window buffer). Arrays of at least
+ *  one huge page are placed on 2 MB pages if the system gives them; otherwise it silently falls back to normal pages.</summary>
+ */
+
+class HugePageAllocator
+{
+	public:
+		static const size_t HugePageSize = 2 * 1024 * 1024;	///< Size of one huge page
+
+		/**
+		 * <summary> Allocates memory, on huge pages if possible.</summary>
+		 *
+		 * <param name="bytes"> Number of bytes to allocate.</param>
+		 *
+		 * <returns> The allocated memory.</returns>
+		 */
+
+		static void * Allocate(size_t bytes);
+
+		/**
+		 * <summary> Frees memory obtained from Allocate.</summary>
+		 *
+		 * <param name="memory"> The memory.</param>
+		 * <param name="bytes">  Number of bytes that were allocated.</param>
+		 */
+
+		static void Free(void * memory, size_t bytes);
+
+		/**
+		 * <summary> Allocates array and constructs all its items.</summary>
+		 *
+		 * <param name="count"> Number of items.</param>
+		 *
+		 * <returns> The array.</returns>
+		 */
+
+		template <typename Item>
+		static Item * NewArray(size_t count);
+
+		/**
+		 * <summary> Destroys all items of array and frees it.</summary>
+		 *
+		 * <param name="items"> The array from NewArray.</param>
+		 * <param name="count"> Number of items.</param>
+		 */
+
+		template <typename Item>
+		static void DeleteArray(Item * items, size_t count);
+
+		/**
+		 * <summary> Gets number of bytes allocated so far.</summary>
+		 *
+		 * <returns> The bytes allocated.</returns>
+		 */
+
+		static size_t GetBytesAllocated();
+
+		/**
+		 * <summary> Gets number of bytes allocated so far on huge pages (explicitly or by transparent huge pages advice).</summary>
+		 *
+		 * <returns> The bytes on huge pages.</returns>
+		 */
+
+		static size_t GetBytesOnHugePages();
+
+		/**
+		 * <summary> Check if huge pages were obtained explicitly (not only advised to the kernel).</summary>
+		 *
+		 * <returns> True if explicit huge pages were obtained, false if not.</returns>
+		 */
+
+		static bool ExplicitHugePagesObtained();
+
+	private:
+		static size_t bytesAllocated;		///< Bytes allocated so far
+		static size_t bytesOnHugePages;		///< Bytes allocated so far on huge pages
+		static bool explicitHugePages;		///< Whether some allocation got explicit huge pages
+
+		/**
+		 * <summary> Rounds size up to multiple of huge page size.</summary>
+		 *
+		 * <param name="bytes"> Number of bytes.</param>
+		 *
+		 * <returns> The rounded size.</returns>
+		 */
+
+		static size_t RoundUp(size_t bytes);
+};
+
+template <typename Item>
+Item * HugePageAllocator::NewArray(size_t count)
+{
+	Item * items = static_cast<Item*>(Allocate(count * sizeof(Item)));
+
+	for (size_t i = 0; i < count; i++)
+	{
+		new (&items[i]) Item();
+	}
+
+	return items;
+}
+
+template <typename Item>
+void HugePageAllocator::DeleteArray(Item * items, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		items[i].~Item();
+	}
+
+	Free(items, count * sizeof(Item));
+}
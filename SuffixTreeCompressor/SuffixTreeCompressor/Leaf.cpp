@@ -13,8 +13,3 @@ Leaf::~Leaf()
 //{
 //	VertexBase::WriteVertex(level, labelStart + this->offsetInBuffer, *labelEnd, buffer);
 //}
-
-int Leaf::UpdateOffset()
-{
-	return this->offsetInBuffer;
-}
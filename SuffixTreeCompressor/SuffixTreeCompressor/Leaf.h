@@ -22,12 +22,4 @@ class Leaf : public VertexBase
 		 */
 
 		//void WriteVertex(int level, int labelStart, int *labelEnd, Buffer* buffer);
-
-		/**
-		 * <summary> Updates the offset - gets current offset from leaf</summary>
-		 *
-		 * <returns> The leaf offset.</returns>
-		 */
-
-		int UpdateOffset();
 };
\ No newline at end of file
@@ -0,0 +1,346 @@
+#pragma once
+
+#include <climits>
+#include <unordered_map>
+#include <vector>
+#include "Stream.hh"
+#include "TokenInputStream.h"
+
+using namespace std;
+
+/**
+ * <summary> A struct to save repetition that is farther than the sliding window.</summary>
+ */
+
+struct LongRangeMatch
+{
+	public:
+		long long Position;		///< Position of the first repeated token in the input
+		long long Distance;		///< Distance of the earlier occurrence
+		int Length;				///< Number of repeated tokens
+};
+
+/**
+ * <summary> Pre-pass that reads the whole input and finds long repetitions anywhere in it. Tokens are split into chunks
+ *  by content (rolling hash over token IDs), so the same run of tokens gives the same chunks wherever it occurs. Repeated
+ *  chunks farther than the sliding window are extended to the longest run and handed to the compressor, which writes
+ *  them as long-range references and keeps the local matches for itself.</summary>
+ */
+
+ //Declaration----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+class LongRangeMatcher
+{
+	public:
+		static const int MarkerIndex = 8;				///< Index of zero-length match that marks long-range reference (end of data uses indices 0-7)
+		static const short ExtraBytesCount = 12;		///< Bytes behind the marker - distance (8 bytes) and length (4 bytes)
+		static const int MinLength = 64;				///< The shortest repetition worth long-range reference
+		static const int MinChunkLength = 8;			///< The shortest chunk
+		static const int MaxChunkLength = 1024;			///< The longest chunk (runs of one token never end the chunk by content)
+		static const unsigned long long ChunkMask = 0x1f;	///< Chunk ends where rolling hash has these bits zero (about 32 tokens per chunk)
+		static const int ReadChunkSize = 1 << 16;		///< Number of raw symbols read at once
+
+		LongRangeMatcher(int windowSize);
+
+		/**
+		 * <summary> Puts symbols of the reference file before the input, so that matches can reach into it. Positions of matches
+		 *  stay relative to the input. It has to be called before loading the input.</summary>
+		 *
+		 * <param name="reference"> The reference symbols.</param>
+		 */
+
+		void AddReference(const vector<T> & reference);
+
+		/**
+		 * <summary> Reads all tokens of the input and finds long-range matches.</summary>
+		 *
+		 * <param name="inputStream"> The input stream.</param>
+		 */
+
+		void Load(TokenInputStream * inputStream);
+
+		/**
+		 * <summary> Reads all raw symbols of the input and finds long-range matches.</summary>
+		 *
+		 * <param name="inStream"> The input stream.</param>
+		 */
+
+		void Load(InStream<T> * inStream);
+
+		/**
+		 * <summary> Reads the next loaded token.</summary>
+		 *
+		 * <param name="token"> The token.</param>
+		 *
+		 * <returns> False if there are no more tokens.</returns>
+		 */
+
+		bool ReadToken(T & token);
+
+		/**
+		 * <summary> Gets position of the next long-range match (LLONG_MAX if none).</summary>
+		 *
+		 * <returns> The position.</returns>
+		 */
+
+		long long NextMatchPosition();
+
+		/**
+		 * <summary> Takes the next long-range match.</summary>
+		 *
+		 * <returns> The match.</returns>
+		 */
+
+		LongRangeMatch TakeMatch();
+
+		/**
+		 * <summary> Drops matches that start before the position (their symbols were written in other way).</summary>
+		 *
+		 * <param name="position"> The position.</param>
+		 */
+
+		void SkipMatches(long long position);
+
+		/**
+		 * <summary> Gets number of long-range matches found.</summary>
+		 *
+		 * <returns> The matches count.</returns>
+		 */
+
+		int GetMatchesCount();
+
+		/**
+		 * <summary> Encode distance and length of the match into bytes behind the marker.</summary>
+		 *
+		 * <param name="match"> The match.</param>
+		 * <param name="bytes"> The bytes (ExtraBytesCount).</param>
+		 */
+
+		static void EncodeExtraBytes(const LongRangeMatch & match, uchar * bytes);
+
+		/**
+		 * <summary> Decode distance and length of the match from bytes behind the marker.</summary>
+		 *
+		 * <param name="bytes">	   The bytes (ExtraBytesCount).</param>
+		 * <param name="distance"> The distance.</param>
+		 * <param name="length">   The length.</param>
+		 */
+
+		static void DecodeExtraBytes(const uchar * bytes, long long & distance, int & length);
+
+	private:
+		int windowSize;						///< Size of the sliding window - closer repetitions are left to the compressor
+		vector<T> tokens;					///< All tokens of the input
+		vector<LongRangeMatch> matches;		///< Found matches ordered by position
+		long long readPosition;				///< Position of the next token to read
+		long long origin;					///< Position of the first input token (behind the reference)
+		size_t nextMatch;					///< Index of the next match to take
+
+		/**
+		 * <summary> Splits tokens into chunks and finds repeated ones.</summary>
+		 */
+
+		void FindMatches();
+
+		/**
+		 * <summary> Mixes bits of token ID for the rolling hash.</summary>
+		 *
+		 * <param name="token"> The token.</param>
+		 *
+		 * <returns> The mixed value.</returns>
+		 */
+
+		static unsigned long long Mix(unsigned long long token);
+};
+
+//Definition----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+LongRangeMatcher<T>::LongRangeMatcher(int windowSize)
+{
+	this->windowSize = windowSize;
+	this->readPosition = 0;
+	this->origin = 0;
+	this->nextMatch = 0;
+}
+
+template <typename T>
+void LongRangeMatcher<T>::AddReference(const vector<T> & reference)
+{
+	tokens.assign(reference.begin(), reference.end());
+	origin = readPosition = tokens.size();
+}
+
+template <typename T>
+void LongRangeMatcher<T>::Load(TokenInputStream * inputStream)
+{
+	//the end sentinel doesn't fit into unsigned symbol, so it is checked before the conversion
+	int tokenId;
+	while ((tokenId = inputStream->ReadToken()) != -1)
+	{
+		tokens.push_back((T)tokenId);
+	}
+
+	FindMatches();
+}
+
+template <typename T>
+void LongRangeMatcher<T>::Load(InStream<T> * inStream)
+{
+	int symbolsRead;
+	do
+	{
+		size_t count = tokens.size();
+		tokens.resize(count + ReadChunkSize);
+		symbolsRead = inStream->ReadSymbols(tokens.data() + count, ReadChunkSize);
+		tokens.resize(count + symbolsRead);
+	} while (symbolsRead > 0);
+
+	FindMatches();
+}
+
+template <typename T>
+inline bool LongRangeMatcher<T>::ReadToken(T & token)
+{
+	if (readPosition >= (long long)tokens.size())
+		return false;
+
+	token = tokens[readPosition++];
+	return true;
+}
+
+template <typename T>
+inline long long LongRangeMatcher<T>::NextMatchPosition()
+{
+	return (nextMatch < matches.size()) ? matches[nextMatch].Position : LLONG_MAX;
+}
+
+template <typename T>
+inline LongRangeMatch LongRangeMatcher<T>::TakeMatch()
+{
+	return matches[nextMatch++];
+}
+
+template <typename T>
+void LongRangeMatcher<T>::SkipMatches(long long position)
+{
+	while (nextMatch < matches.size() && matches[nextMatch].Position < position)
+	{
+		nextMatch++;
+	}
+}
+
+template <typename T>
+int LongRangeMatcher<T>::GetMatchesCount()
+{
+	return matches.size();
+}
+
+template <typename T>
+void LongRangeMatcher<T>::EncodeExtraBytes(const LongRangeMatch & match, uchar * bytes)
+{
+	for (short i = 0; i < 8; i++)
+	{
+		bytes[i] = (match.Distance >> ((7 - i) * 8)) & 0xff;
+	}
+
+	for (short i = 0; i < 4; i++)
+	{
+		bytes[8 + i] = (match.Length >> ((3 - i) * 8)) & 0xff;
+	}
+}
+
+template <typename T>
+void LongRangeMatcher<T>::DecodeExtraBytes(const uchar * bytes, long long & distance, int & length)
+{
+	distance = 0;
+	for (short i = 0; i < 8; i++)
+	{
+		distance = (distance << 8) | bytes[i];
+	}
+
+	length = 0;
+	for (short i = 0; i < 4; i++)
+	{
+		length = (length << 8) | bytes[8 + i];
+	}
+}
+
+template <typename T>
+void LongRangeMatcher<T>::FindMatches()
+{
+	long long count = tokens.size();
+	unordered_map<unsigned long long, long long> chunks;	//fingerprint of chunk -> position of its latest occurrence
+	long long coveredEnd = origin;	//tokens before are already in some match (or in the reference)
+	long long chunkStart = 0;
+	unsigned long long rollingHash = 0;
+	unsigned long long fingerprint = 0;
+
+	for (long long i = 0; i < count; i++)
+	{
+		//every token is shifted out of the hash after 64 steps, so chunk borders depend only on the nearby content
+		rollingHash = (rollingHash << 1) + Mix(tokens[i]);
+		fingerprint = (fingerprint ^ Mix(tokens[i])) * 0x100000001B3ULL;
+
+		long long chunkLength = i + 1 - chunkStart;
+		if ((chunkLength < MinChunkLength || (rollingHash & ChunkMask) != 0) && chunkLength < MaxChunkLength && i + 1 < count)
+			continue;
+
+		unordered_map<unsigned long long, long long>::iterator found = chunks.find(fingerprint);
+		long long source = (found != chunks.end()) ? found->second : -1;
+		chunks[fingerprint] = chunkStart;
+
+		if (source >= 0 && chunkStart - source > windowSize && chunkStart >= coveredEnd)
+		{
+			long long distance = chunkStart - source;
+
+			//fingerprints may collide - the chunk has to be really the same
+			long long length = 0;
+			while (length < chunkLength && tokens[source + length] == tokens[chunkStart + length])
+			{
+				length++;
+			}
+
+			if (length == chunkLength)
+			{
+				long long start = chunkStart;
+				while (start > coveredEnd && start - distance > 0 && tokens[start - 1] == tokens[start - 1 - distance])
+				{
+					start--;
+				}
+
+				long long end = chunkStart + chunkLength;
+				while (end < count && end - start < INT_MAX && tokens[end] == tokens[end - distance])
+				{
+					end++;
+				}
+
+				if (end - start >= MinLength)
+				{
+					LongRangeMatch match;
+					match.Position = start - origin;
+					match.Distance = distance;
+					match.Length = end - start;
+					matches.push_back(match);
+
+					//continue chunking behind the match
+					coveredEnd = end;
+					i = end - 1;
+					rollingHash = 0;
+				}
+			}
+		}
+
+		chunkStart = i + 1;
+		fingerprint = 0;
+	}
+}
+
+template <typename T>
+inline unsigned long long LongRangeMatcher<T>::Mix(unsigned long long token)
+{
+	token = (token ^ (token >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	token = (token ^ (token >> 27)) * 0x94D049BB133111EBULL;
+	return token ^ (token >> 31);
+}
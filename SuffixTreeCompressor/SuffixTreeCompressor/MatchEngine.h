@@ -0,0 +1,12 @@
+#pragma once
+
+/**
+ * <summary> Values that represent engines used for finding matches during compression.</summary>
+ */
+
+enum MatchEngineEnum
+{
+	SuffixTreeEngine,	///< Online suffix tree over the sliding window
+	SuffixArrayEngine,	///< Suffix array and LCP array built over blocks
+	HashChainEngine		///< Hash chains over blocks with bounded search depth
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+/**
+ * <summary> Interface of block match finders - engines that find, for every position of a block of symbols,
+ *  the longest match with some previous position (in the block or in the history in front of it).</summary>
+ */
+
+ //Declaration----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+class MatchFinder
+{
+	public:
+		virtual ~MatchFinder() = default;
+
+		/**
+		 * <summary> Finds the longest previous-occurrence match for every position of the block.</summary>
+		 *
+		 * <param name="symbols">		 The history (already processed symbols) followed by the block.</param>
+		 * <param name="historyLength">  Number of history symbols in front of the block.</param>
+		 * <param name="length">		 Total number of symbols - history and block.</param>
+		 * <param name="matchLengths">	 Longest match length for every block position (output, 0 if there is no match).</param>
+		 * <param name="matchDistances"> Distance back to the start of the longest match for every block position (output).</param>
+		 */
+
+		virtual void FindMatches(const T * symbols, int historyLength, int length, int * matchLengths, int * matchDistances) = 0;
+};
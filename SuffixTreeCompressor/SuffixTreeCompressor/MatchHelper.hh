@@ -20,7 +20,7 @@ class MatchHelper
 		int MatchBufPosition;		///< The match position relative to start of buffer
 
 		MatchHelper() = default;
-		MatchHelper(int matchBitsSize, T * matchChars, short bytesPerMatchCount);
+		MatchHelper(int matchLengthMaxValue, T * matchChars, short bytesPerMatchCount);
 		~MatchHelper() = default;
 
 		/**
@@ -63,7 +63,7 @@ class MatchHelper
 		Match GetMatchWithZeroLength(short remainingBytesCount);
 	private:
 		int matchLength;			///< Current match length
-		int matchLengthMaxValue;	///< The maximum match length (not to overflow max bits size)
+		int matchLengthMaxValue;	///< The maximum match length (not to overflow length field with its extension)
 		T * matchChars;			///< The match characters that are used if the match is not long enough
 		short bytesPerMatchCount;   ///< Number of bytes per one match
 };
@@ -71,11 +71,11 @@ class MatchHelper
 //Definition----------------------------------------------------------------------------------------------------------------------------------------------------------
 
 template<typename T>
-MatchHelper<T>::MatchHelper(int matchBitsSize, T * matchChars, short bytesPerMatchCount)
+MatchHelper<T>::MatchHelper(int matchLengthMaxValue, T * matchChars, short bytesPerMatchCount)
 {
 	this->matchLength = 0;
 	this->MatchPosition = -1;
-	this->matchLengthMaxValue = (1 << matchBitsSize) - 1;
+	this->matchLengthMaxValue = matchLengthMaxValue;
 	this->matchChars = matchChars;
 	this->bytesPerMatchCount = bytesPerMatchCount;
 }
@@ -1,19 +1,38 @@
 #pragma once
 #include "Stream.hh"
+#include "Encoder.h"
 
 /**
- * <summary> Helper to handle output bytes - save them to group them into groups of 8 and then output them.</summary>
+ * <summary> Helper to handle output items - save them to group them into groups of 8 and then output them as bit fields
+ *  behind the byte of their flags. Literals take the bits of symbol and matches the bits of their code, so nothing is
+ *  rounded to whole bytes.
+ *  
+ *  Sequence layout is the alternative without flags - every match (or marker) is preceded by the number of literals in
+ *  front of it and by the literals themselves, so the decoder copies whole runs of literals and branches once per
+ *  sequence. The run has LiteralRunBits field extended by bytes the same way as match length, a run of MaxLiteralRun
+ *  literals is not followed by match (long runs are split). End of data is zero-length match with index zero.
+ *  
+ *  Split layout keeps the flags, but every block of SplitBlockItems items goes out as three contiguous sub-streams - flags,
+ *  literals (with symbols of stored blocks) and match codes (with their extra bytes). The block header holds number of
+ *  items and bytes of literals and matches, every sub-stream is padded to a byte. End of data is zero-length match with
+ *  index zero as in sequence layout.</summary>
  */
 
 template <typename T> 
 class OutputBytesHelper
 {
 	public:
-		OutputBytesHelper(const char * outFileName, short bytesPerMatchCount, OutStream<T> * outStream);
+		static const short MaxExtraBytesCount = 16;	///< The most bytes that can follow one match
+		static const short LiteralRunBits = 4;		///< Bits of the literal run field of sequence
+		static const int MaxLiteralRun = 1 << 16;	///< The longest literal run of sequence - such run is not followed by match
+		static const int SplitBlockItems = 1 << 16;	///< Number of items per block of split layout (the last block may be shorter)
+		static const short SplitCountBits = 32;		///< Bits of every count in header of split block
+
+		OutputBytesHelper(const char * outFileName, short matchBits, OutStream<T> * outStream, bool sequences = false, bool splitStreams = false);
 		~OutputBytesHelper();
 
 		/**
-		 * <summary> Appends a symbol to bytesForOutput array.</summary>
+		 * <summary> Appends a symbol to the fields of the group.</summary>
 		 *
 		 * <param name="symbol"> The symbol to be appended.</param>
 		 */
@@ -21,12 +40,47 @@ class OutputBytesHelper
 		void AppendSymbol(T symbol);
 
 		/**
-		 * <summary> Appends a match to bytesForOutput array.</summary>
+		 * <summary> Appends a match to the fields of the group.</summary>
+		 *
+		 * <param name="matchCode"> Code of the match.</param>
+		 */
+
+		void AppendMatch(unsigned long long matchCode);
+
+		/**
+		 * <summary> Appends a match followed by extra bytes (e.g. long-range reference) to the fields of the group.</summary>
 		 *
-		 * <param name="matchBytes"> Match bytes to be appended.</param>
+		 * <param name="matchCode">		   Code of the match.</param>
+		 * <param name="extraBytes">	   Bytes that follow the match.</param>
+		 * <param name="extraBytesCount"> Number of extra bytes (at most MaxExtraBytesCount).</param>
 		 */
 
-		void AppendMatch(uchar * matchBytes);
+		void AppendMatch(unsigned long long matchCode, uchar * extraBytes, short extraBytesCount);
+
+		/**
+		 * <summary> Appends a match whose code is not of the usual size (repeat code) followed by extra bytes to the fields of
+		 *  the group.</summary>
+		 *
+		 * <param name="matchCode">		   Code of the match.</param>
+		 * <param name="matchCodeBits">   Number of bits of the code.</param>
+		 * <param name="extraBytes">	   Bytes that follow the match.</param>
+		 * <param name="extraBytesCount"> Number of extra bytes (at most MaxExtraBytesCount).</param>
+		 */
+
+		void AppendMatch(unsigned long long matchCode, short matchCodeBits, uchar * extraBytes, short extraBytesCount);
+
+		/**
+		 * <summary> Appends a match followed by extra bytes and symbols of stored block. The block can be long, so it is written
+		 *  right away together with the current group - the rest of flags of the group stays unused.</summary>
+		 *
+		 * <param name="matchCode">		   Code of the match.</param>
+		 * <param name="extraBytes">	   Bytes that follow the match.</param>
+		 * <param name="extraBytesCount"> Number of extra bytes (at most MaxExtraBytesCount).</param>
+		 * <param name="symbols">		   Symbols of the stored block.</param>
+		 * <param name="symbolsCount">	   Number of the symbols.</param>
+		 */
+
+		void AppendStoredBlock(unsigned long long matchCode, uchar * extraBytes, short extraBytesCount, const T * symbols, int symbolsCount);
 
 		/**
 		 * <summary> Gets number of flags that are remaining to be output.</summary>
@@ -37,82 +91,339 @@ class OutputBytesHelper
 		short GetRemainingFlagsCount();
 
 		/**
-		 * <summary> Finishes a work - write the remaining bytesToOutput to outStream prepended by zeroLengthMatch (signal of end).</summary>
+		 * <summary> Gets encoded size of the items appended up to now in bits - with their flags (literal run fields of
+		 *  sequences), but without padding and headers of blocks. The items may not be written to outStream yet.</summary>
 		 *
-		 * <param name="zeroLengthMatchBytes"> Bytes of match that is zero-length.</param>
+		 * <returns> The appended bits.</returns>
+		 */
+
+		long long GetAppendedBits();
+
+		/**
+		 * <summary> Sets bits of literal that are counted in appended bits - literals are smaller than their symbols if the
+		 *  output is entropy coded afterwards.</summary>
+		 *
+		 * <param name="literalBits"> Bits of one literal.</param>
+		 */
+
+		void SetLiteralBits(short literalBits);
+
+		/**
+		 * <summary> Marks the current state together with the position of outStream, so that the items appended behind it can
+		 *  be taken back.</summary>
+		 */
+
+		void SetMark();
+
+		/**
+		 * <summary> Takes back the items appended since the mark - the mark stays set.</summary>
 		 */
 
-		void FinishWork(uchar * zeroLengthMatchBytes);
+		void RewindToMark();
+
+		/**
+		 * <summary> Releases the mark of the state and of outStream.</summary>
+		 */
+
+		void ReleaseMark();
+
+		/**
+		 * <summary> Finishes a work - write the remaining fields to outStream prepended by zeroLengthMatch (signal of end). The
+		 *  last byte is padded with zero bits.</summary>
+		 *
+		 * <param name="zeroLengthMatchCode"> Code of match that is zero-length.</param>
+		 */
+
+		void FinishWork(unsigned long long zeroLengthMatchCode);
+
+		/**
+		 * <summary> Ends independent block the same way as the whole output ends, so that the next block starts with new group
+		 *  of flags at byte border.</summary>
+		 *
+		 * <param name="zeroLengthMatchCode"> Code of match that is zero-length.</param>
+		 */
+
+		void EndBlock(unsigned long long zeroLengthMatchCode);
 
 	private:
 		OutStream<T> * outStream;		///< The stream to write data to
-		short bytesPerMatchCount;	///< The number of bytes per match - number of bits reserved for index in sliding window + number of bits reserved for match length
+		short matchBits;			///< The number of bits per match - number of bits reserved for index in buffer + number of bits reserved for match length (+ flag bit of repeat codes)
 		uchar flagsByte;			///< The byte with flags signaling symbol or match (1 = symbol, 0 = match)
 		short flagsCount;			///< The number of flags currently saved in flagsByte
-		short bytesToOutputCount;	///< The number of bytes currently saved in bytesToOutput
-		uchar * bytesToOutput;		///< The bytes to output
+		short fieldsCount;			///< The number of fields currently saved in fieldValues
+		long long appendedBits;		///< Encoded size of the items appended up to now in bits
+		short literalBits;			///< Bits of literal counted in appendedBits
+		unsigned long long * fieldValues;	///< The fields to output
+		short * fieldBits;			///< Number of bits of every field to output
+		bool sequences;				///< Whether items are written as sequences instead of groups of flags
+		T * literalRun;				///< Literals of the current sequence
+		int literalRunLength;		///< Number of literals of the current sequence
+		bool splitStreams;			///< Whether items are written as blocks of three sub-streams
+		int splitItems;				///< Number of items of the current split block
+		vector<uchar> splitFlags;	///< Flags sub-stream of the current split block
+		vector<uchar> splitLiterals;	///< Literals sub-stream of the current split block
+		vector<uchar> splitMatches;	///< Matches sub-stream of the current split block
+		BitWriter flagsWriter;		///< The writer of splitFlags
+		BitWriter literalsWriter;	///< The writer of splitLiterals
+		BitWriter matchesWriter;	///< The writer of splitMatches
+		uchar markedFlagsByte;		///< flagsByte at the mark
+		short markedFlagsCount;		///< flagsCount at the mark
+		short markedFieldsCount;	///< fieldsCount at the mark
+		long long markedAppendedBits;	///< appendedBits at the mark
+		short markedLiteralBits;	///< literalBits at the mark
+		unsigned long long * markedFieldValues;	///< fieldValues at the mark
+		short * markedFieldBits;	///< fieldBits at the mark
+		vector<T> markedLiteralRun;	///< literalRun at the mark
+		int markedSplitItems;		///< splitItems at the mark
+		vector<uchar> markedSplitFlags;	///< splitFlags at the mark
+		vector<uchar> markedSplitLiterals;	///< splitLiterals at the mark
+		vector<uchar> markedSplitMatches;	///< splitMatches at the mark
+		BitWriter markedFlagsWriter;	///< flagsWriter at the mark
+		BitWriter markedLiteralsWriter;	///< literalsWriter at the mark
+		BitWriter markedMatchesWriter;	///< matchesWriter at the mark
+
+		/**
+		 * <summary> Saves field of the group.</summary>
+		 *
+		 * <param name="value"> The value.</param>
+		 * <param name="bits">	 Number of bits.</param>
+		 */
+
+		void AppendField(unsigned long long value, short bits);
+
+		/**
+		 * <summary> Writes the flags byte and the saved fields and starts new group.</summary>
+		 */
+
+		void WriteGroup();
 
 		/**
 		 * <summary> Check flags count - if there is 8 of them, output them.</summary>
 		 */
 
 		void CheckFlagsCount();
+
+		/**
+		 * <summary> Writes the literal run of the current sequence (its length and the literals) and starts new run.</summary>
+		 */
+
+		void WriteLiteralRun();
+
+		/**
+		 * <summary> Writes the current sequence ended by the match.</summary>
+		 *
+		 * <param name="matchCode">		   Code of the match.</param>
+		 * <param name="matchCodeBits">   Number of bits of the code.</param>
+		 * <param name="extraBytes">	   Bytes that follow the match.</param>
+		 * <param name="extraBytesCount"> Number of extra bytes.</param>
+		 */
+
+		void WriteSequence(unsigned long long matchCode, short matchCodeBits, uchar * extraBytes, short extraBytesCount);
+
+		/**
+		 * <summary> Appends match with its extra bytes to the current split block.</summary>
+		 *
+		 * <param name="matchCode">		   Code of the match.</param>
+		 * <param name="matchCodeBits">   Number of bits of the code.</param>
+		 * <param name="extraBytes">	   Bytes that follow the match.</param>
+		 * <param name="extraBytesCount"> Number of extra bytes.</param>
+		 */
+
+		void AppendSplitMatch(unsigned long long matchCode, short matchCodeBits, uchar * extraBytes, short extraBytesCount);
+
+		/**
+		 * <summary> Counts item of the current split block - the full block is written out.</summary>
+		 */
+
+		void CheckSplitItems();
+
+		/**
+		 * <summary> Writes the header and sub-streams of the current split block and starts new one.</summary>
+		 */
+
+		void WriteSplitBlock();
 };
 
 //Definition----------------------------------------------------------------------------------------------------------------------------------------------------------
 
 template <typename T>
-OutputBytesHelper<T>::OutputBytesHelper(const char * outFileName, short bytesPerMatchCount, OutStream<T> * outStream)
+OutputBytesHelper<T>::OutputBytesHelper(const char * outFileName, short matchBits, OutStream<T> * outStream, bool sequences, bool splitStreams)
 {
 	this->outStream = outStream;
-	this->bytesPerMatchCount = bytesPerMatchCount;
+	this->matchBits = matchBits;
+	this->sequences = sequences;
+	this->literalRun = sequences ? new T[MaxLiteralRun] : NULL;
+	this->literalRunLength = 0;
+	this->splitStreams = splitStreams;
+	this->splitItems = 0;
+	this->flagsWriter = BitWriter(&splitFlags);
+	this->literalsWriter = BitWriter(&splitLiterals);
+	this->matchesWriter = BitWriter(&splitMatches);
+	this->flagsByte = 0;
 	this->flagsCount = 0;
-	this->bytesToOutputCount = 0;
-
-	short maxBytesPerItemUsed = (bytesPerMatchCount > sizeof(T)) ? bytesPerMatchCount : sizeof(T);	//T msto int; 
-	this->bytesToOutput = new uchar[8 * maxBytesPerItemUsed];
+	this->fieldsCount = 0;
+	this->appendedBits = 0;
+	this->literalBits = 8 * sizeof(T);
+
+	//the most fields per item has match with extra bytes
+	this->fieldValues = new unsigned long long[8 * (1 + MaxExtraBytesCount)];
+	this->fieldBits = new short[8 * (1 + MaxExtraBytesCount)];
+	this->markedFieldValues = NULL;
+	this->markedFieldBits = NULL;
 }
 
 template <typename T>
 OutputBytesHelper<T>::~OutputBytesHelper()
 {
-	delete[] this->bytesToOutput;
+	delete[] this->fieldValues;
+	delete[] this->fieldBits;
+	delete[] this->literalRun;
+	delete[] this->markedFieldValues;
+	delete[] this->markedFieldBits;
+}
+
+template <typename T>
+inline void OutputBytesHelper<T>::AppendField(unsigned long long value, short bits)
+{
+	fieldValues[fieldsCount] = value;
+	fieldBits[fieldsCount++] = bits;
 }
 
 template <typename T>
 void OutputBytesHelper<T>::AppendSymbol(T symbol)
 {
+	appendedBits += (sequences ? 0 : 1) + literalBits;
+
+	if (sequences)
+	{
+		literalRun[literalRunLength++] = symbol;
+		if (literalRunLength == MaxLiteralRun)
+		{
+			WriteLiteralRun();
+		}
+		return;
+	}
+
+	if (splitStreams)
+	{
+		flagsWriter.Write(1, 1);
+		literalsWriter.Write(symbol, 8 * sizeof(T));
+		CheckSplitItems();
+		return;
+	}
+
 	uchar flagMask = 1 << (8 - flagsCount - 1);
 	flagsByte |= flagMask;
 
-	//take byte by byte of symbol from left to right (shift to the right by multipliers of 8 and leave set only rightmost byte)
-	for (short i = sizeof(T) - 1; i >= 0; i--)
+	AppendField(symbol, 8 * sizeof(T));
+	flagsCount++;
+
+	CheckFlagsCount();
+}
+
+template <typename T>
+void OutputBytesHelper<T>::AppendMatch(unsigned long long matchCode)
+{
+	appendedBits += (sequences ? LiteralRunBits : 1) + matchBits;
+
+	if (sequences)
+	{
+		WriteSequence(matchCode, matchBits, NULL, 0);
+		return;
+	}
+
+	if (splitStreams)
 	{
-		bytesToOutput[bytesToOutputCount++] = (symbol >> (i * 8)) & 0xff;
+		AppendSplitMatch(matchCode, matchBits, NULL, 0);
+		return;
 	}
 
+	uchar flagMask = 1 << (8 - flagsCount - 1);
+	flagsByte &= ~flagMask;
+
+	AppendField(matchCode, matchBits);
 	flagsCount++;
 
 	CheckFlagsCount();
 }
 
 template <typename T>
-void OutputBytesHelper<T>::AppendMatch(uchar * matchBytes)
+void OutputBytesHelper<T>::AppendMatch(unsigned long long matchCode, uchar * extraBytes, short extraBytesCount)
+{
+	AppendMatch(matchCode, matchBits, extraBytes, extraBytesCount);
+}
+
+template <typename T>
+void OutputBytesHelper<T>::AppendMatch(unsigned long long matchCode, short matchCodeBits, uchar * extraBytes, short extraBytesCount)
 {
+	appendedBits += (sequences ? LiteralRunBits : 1) + matchCodeBits + 8 * extraBytesCount;
+
+	if (sequences)
+	{
+		WriteSequence(matchCode, matchCodeBits, extraBytes, extraBytesCount);
+		return;
+	}
+
+	if (splitStreams)
+	{
+		AppendSplitMatch(matchCode, matchCodeBits, extraBytes, extraBytesCount);
+		return;
+	}
+
 	uchar flagMask = 1 << (8 - flagsCount - 1);
 	flagsByte &= ~flagMask;
 
-	for (short i = 0; i < bytesPerMatchCount; i++)
+	AppendField(matchCode, matchCodeBits);
+	for (short i = 0; i < extraBytesCount; i++)
 	{
-		bytesToOutput[bytesToOutputCount + i] = matchBytes[i];
+		AppendField(extraBytes[i], 8);
 	}
 
-	bytesToOutputCount += bytesPerMatchCount;
 	flagsCount++;
 
 	CheckFlagsCount();
 }
 
+template <typename T>
+void OutputBytesHelper<T>::AppendStoredBlock(unsigned long long matchCode, uchar * extraBytes, short extraBytesCount, const T * symbols, int symbolsCount)
+{
+	appendedBits += (sequences ? LiteralRunBits : 1) + matchBits + 8 * extraBytesCount + 8 * sizeof(T) * (long long)symbolsCount;
+
+	if (sequences)
+	{
+		WriteSequence(matchCode, matchBits, extraBytes, extraBytesCount);
+	}
+	else if (splitStreams)
+	{
+		//the symbols go to the literals of the same block as the match
+		for (int i = 0; i < symbolsCount; i++)
+		{
+			literalsWriter.Write(symbols[i], 8 * sizeof(T));
+		}
+
+		AppendSplitMatch(matchCode, matchBits, extraBytes, extraBytesCount);
+		return;
+	}
+	else
+	{
+		uchar flagMask = 1 << (8 - flagsCount - 1);
+		flagsByte &= ~flagMask;
+
+		AppendField(matchCode, matchBits);
+		for (short i = 0; i < extraBytesCount; i++)
+		{
+			AppendField(extraBytes[i], 8);
+		}
+
+		WriteGroup();
+	}
+
+	for (int i = 0; i < symbolsCount; i++)
+	{
+		outStream->WriteBits(symbols[i], 8 * sizeof(T));
+	}
+}
+
 template <typename T>
 short OutputBytesHelper<T>::GetRemainingFlagsCount()
 {
@@ -120,35 +431,225 @@ short OutputBytesHelper<T>::GetRemainingFlagsCount()
 }
 
 template <typename T>
-void OutputBytesHelper<T>::FinishWork(uchar * zeroLengthMatchBytes)
+long long OutputBytesHelper<T>::GetAppendedBits()
 {
-	flagsByte >>= 1;
-	flagsByte &= ~(1 << 7);
+	return appendedBits;
+}
 
-	outStream->WriteByte(flagsByte);
+template <typename T>
+void OutputBytesHelper<T>::SetLiteralBits(short literalBits)
+{
+	this->literalBits = literalBits;
+}
 
-	for (short i = 0; i < bytesPerMatchCount; i++)
+template <typename T>
+void OutputBytesHelper<T>::SetMark()
+{
+	if (markedFieldValues == NULL)
 	{
-		outStream->WriteByte(zeroLengthMatchBytes[i]);
+		markedFieldValues = new unsigned long long[8 * (1 + MaxExtraBytesCount)];
+		markedFieldBits = new short[8 * (1 + MaxExtraBytesCount)];
 	}
 
-	for (short i = 0; i < bytesToOutputCount; i++)
+	markedFlagsByte = flagsByte;
+	markedFlagsCount = flagsCount;
+	markedFieldsCount = fieldsCount;
+	markedAppendedBits = appendedBits;
+	markedLiteralBits = literalBits;
+	copy(fieldValues, fieldValues + fieldsCount, markedFieldValues);
+	copy(fieldBits, fieldBits + fieldsCount, markedFieldBits);
+
+	if (sequences)
+	{
+		markedLiteralRun.assign(literalRun, literalRun + literalRunLength);
+	}
+
+	//the writers append to the sub-streams, so they are restored together
+	if (splitStreams)
 	{
-		outStream->WriteByte(bytesToOutput[i]);
+		markedSplitItems = splitItems;
+		markedSplitFlags = splitFlags;
+		markedSplitLiterals = splitLiterals;
+		markedSplitMatches = splitMatches;
+		markedFlagsWriter = flagsWriter;
+		markedLiteralsWriter = literalsWriter;
+		markedMatchesWriter = matchesWriter;
 	}
+
+	outStream->SetMark();
 }
 
 template <typename T>
-void OutputBytesHelper<T>::CheckFlagsCount()
+void OutputBytesHelper<T>::RewindToMark()
 {
-	if (flagsCount == 8)
+	flagsByte = markedFlagsByte;
+	flagsCount = markedFlagsCount;
+	fieldsCount = markedFieldsCount;
+	appendedBits = markedAppendedBits;
+	literalBits = markedLiteralBits;
+	copy(markedFieldValues, markedFieldValues + fieldsCount, fieldValues);
+	copy(markedFieldBits, markedFieldBits + fieldsCount, fieldBits);
+
+	if (sequences)
+	{
+		literalRunLength = (int)markedLiteralRun.size();
+		copy(markedLiteralRun.begin(), markedLiteralRun.end(), literalRun);
+	}
+
+	if (splitStreams)
+	{
+		splitItems = markedSplitItems;
+		splitFlags = markedSplitFlags;
+		splitLiterals = markedSplitLiterals;
+		splitMatches = markedSplitMatches;
+		flagsWriter = markedFlagsWriter;
+		literalsWriter = markedLiteralsWriter;
+		matchesWriter = markedMatchesWriter;
+	}
+
+	outStream->RewindToMark();
+}
+
+template <typename T>
+void OutputBytesHelper<T>::ReleaseMark()
+{
+	outStream->ReleaseMark();
+}
+
+template <typename T>
+void OutputBytesHelper<T>::FinishWork(unsigned long long zeroLengthMatchCode)
+{
+	//there are no groups of flags, so the end is the last item
+	if (sequences)
+	{
+		WriteSequence(zeroLengthMatchCode, matchBits, NULL, 0);
+		outStream->AlignToByte();
+		return;
+	}
+
+	if (splitStreams)
 	{
-		outStream->WriteByte(flagsByte);
-		for (short i = 0; i < bytesToOutputCount; i++)
+		AppendSplitMatch(zeroLengthMatchCode, matchBits, NULL, 0);
+		if (splitItems > 0)
 		{
-			outStream->WriteByte(bytesToOutput[i]);
+			WriteSplitBlock();
 		}
+		return;
+	}
 
-		flagsCount = bytesToOutputCount = flagsByte = 0;
+	flagsByte >>= 1;
+	flagsByte &= ~(1 << 7);
+
+	outStream->WriteBits(flagsByte, 8);
+	outStream->WriteBits(zeroLengthMatchCode, matchBits);
+	for (short i = 0; i < fieldsCount; i++)
+	{
+		outStream->WriteBits(fieldValues[i], fieldBits[i]);
 	}
-}
\ No newline at end of file
+
+	outStream->AlignToByte();
+}
+
+template <typename T>
+void OutputBytesHelper<T>::EndBlock(unsigned long long zeroLengthMatchCode)
+{
+	FinishWork(zeroLengthMatchCode);
+
+	flagsCount = fieldsCount = flagsByte = 0;
+}
+
+template <typename T>
+void OutputBytesHelper<T>::WriteGroup()
+{
+	outStream->WriteBits(flagsByte, 8);
+	for (short i = 0; i < fieldsCount; i++)
+	{
+		outStream->WriteBits(fieldValues[i], fieldBits[i]);
+	}
+
+	flagsCount = fieldsCount = flagsByte = 0;
+}
+
+template <typename T>
+inline void OutputBytesHelper<T>::CheckFlagsCount()
+{
+	if (flagsCount == 8)
+	{
+		WriteGroup();
+	}
+}
+
+template <typename T>
+void OutputBytesHelper<T>::WriteLiteralRun()
+{
+	uchar extension[Encoder::MaxExtensionBytes];
+	short extensionCount = Encoder::EncodeLengthExtension(literalRunLength, LiteralRunBits, extension);
+
+	outStream->WriteBits(min(literalRunLength, (1 << LiteralRunBits) - 1), LiteralRunBits);
+	for (short i = 0; i < extensionCount; i++)
+	{
+		outStream->WriteBits(extension[i], 8);
+	}
+
+	for (int i = 0; i < literalRunLength; i++)
+	{
+		outStream->WriteBits(literalRun[i], 8 * sizeof(T));
+	}
+
+	literalRunLength = 0;
+}
+
+template <typename T>
+void OutputBytesHelper<T>::WriteSequence(unsigned long long matchCode, short matchCodeBits, uchar * extraBytes, short extraBytesCount)
+{
+	WriteLiteralRun();
+
+	outStream->WriteBits(matchCode, matchCodeBits);
+	for (short i = 0; i < extraBytesCount; i++)
+	{
+		outStream->WriteBits(extraBytes[i], 8);
+	}
+}
+
+template <typename T>
+void OutputBytesHelper<T>::AppendSplitMatch(unsigned long long matchCode, short matchCodeBits, uchar * extraBytes, short extraBytesCount)
+{
+	flagsWriter.Write(0, 1);
+	matchesWriter.Write(matchCode, matchCodeBits);
+	for (short i = 0; i < extraBytesCount; i++)
+	{
+		matchesWriter.Write(extraBytes[i], 8);
+	}
+
+	CheckSplitItems();
+}
+
+template <typename T>
+inline void OutputBytesHelper<T>::CheckSplitItems()
+{
+	if (++splitItems == SplitBlockItems)
+	{
+		WriteSplitBlock();
+	}
+}
+
+template <typename T>
+void OutputBytesHelper<T>::WriteSplitBlock()
+{
+	flagsWriter.Flush();
+	literalsWriter.Flush();
+	matchesWriter.Flush();
+
+	outStream->AlignToByte();
+	outStream->WriteBits(splitItems, SplitCountBits);
+	outStream->WriteBits(splitLiterals.size(), SplitCountBits);
+	outStream->WriteBits(splitMatches.size(), SplitCountBits);
+	outStream->WriteBytes(splitFlags);
+	outStream->WriteBytes(splitLiterals);
+	outStream->WriteBytes(splitMatches);
+
+	splitItems = 0;
+	splitFlags.clear();
+	splitLiterals.clear();
+	splitMatches.clear();
+}
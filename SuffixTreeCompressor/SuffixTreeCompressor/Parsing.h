@@ -0,0 +1,12 @@
+#pragma once
+
+/**
+ * <summary> Values that represent ways of choosing matches and literals from the matches found by block engines.</summary>
+ */
+
+enum ParsingEnum
+{
+	GreedyParsing,	///< The longest match at current position is taken
+	LazyParsing,	///< The match is deferred by one symbol if a longer one starts there
+	OptimalParsing	///< Parse with the smallest encoded size is found by dynamic programming over the block
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include "Stream.hh"
+
+using namespace std;
+
+/**
+ * <summary> Helpers for delta compression against a reference file. The last window of the reference is put into the sliding
+ *  window before the first symbol of the input (without any output), both while compressing and decoding, so the input is
+ *  encoded as matches into the reference. The reference has to be given for decompression too.</summary>
+ */
+
+ //Declaration----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+class Reference
+{
+	public:
+		static const int ReadChunkSize = 1 << 16;		///< Number of raw symbols read at once
+
+		/**
+		 * <summary> Loads symbols of the reference - its tokens, or raw symbols of the file if there are no tokens.</summary>
+		 *
+		 * <param name="referenceFile">   The reference file.</param>
+		 * <param name="referenceTokens"> Tokens of the reference (NULL in byte mode).</param>
+		 * <param name="symbols">		  The symbols.</param>
+		 */
+
+		static void Load(const char * referenceFile, const vector<int> * referenceTokens, vector<T> & symbols);
+
+		/**
+		 * <summary> Gets position of the first symbol that gets into the sliding window.</summary>
+		 *
+		 * <param name="symbols">	 The reference symbols.</param>
+		 * <param name="windowSize"> Size of the sliding window.</param>
+		 *
+		 * <returns> The position.</returns>
+		 */
+
+		static size_t WindowStart(const vector<T> & symbols, int windowSize);
+};
+
+//Definition----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+void Reference<T>::Load(const char * referenceFile, const vector<int> * referenceTokens, vector<T> & symbols)
+{
+	if (referenceTokens != NULL)
+	{
+		symbols.assign(referenceTokens->begin(), referenceTokens->end());
+		return;
+	}
+
+	InStream<T> inStream;
+	inStream.Open(referenceFile, true, true);
+
+	int symbolsRead;
+	do
+	{
+		size_t count = symbols.size();
+		symbols.resize(count + ReadChunkSize);
+		symbolsRead = inStream.ReadSymbols(symbols.data() + count, ReadChunkSize);
+		symbols.resize(count + symbolsRead);
+	} while (symbolsRead > 0);
+
+	inStream.Close();
+}
+
+template <typename T>
+inline size_t Reference<T>::WindowStart(const vector<T> & symbols, int windowSize)
+{
+	return (symbols.size() > (size_t)windowSize) ? symbols.size() - windowSize : 0;
+}
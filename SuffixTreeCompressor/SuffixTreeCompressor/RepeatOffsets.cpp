@@ -0,0 +1,27 @@
+#include "RepeatOffsets.h"
+
+RepeatOffsets::RepeatOffsets()
+{
+	Reset();
+}
+
+void RepeatOffsets::Reset()
+{
+	for (short i = 0; i < Count; i++)
+	{
+		this->matchIndices[i] = 0;
+	}
+}
+
+void RepeatOffsets::Update(int matchIndex)
+{
+	short slot = Find(matchIndex);
+	if (slot < 0)
+		slot = Count - 1;
+
+	for (short i = slot; i > 0; i--)
+	{
+		matchIndices[i] = matchIndices[i - 1];
+	}
+	matchIndices[0] = matchIndex;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+/**
+ * <summary> History of the last match indices, the most recent first. Indices are relative to the front of buffer, so they
+ *  stay valid while the window slides. Match that reuses one of them is written as short repeat code with the slot of the
+ *  index - the encoder and the decoder update the history the same way after every match.</summary>
+ */
+
+class RepeatOffsets
+{
+	public:
+		static const short Count = 4;		///< Number of remembered match indices
+		static const short SlotBits = 2;	///< Bits of slot in repeat code
+
+		RepeatOffsets();
+
+		/**
+		 * <summary> Forgets all indices (start of independent block). Empty slot holds zero - no match has such index.</summary>
+		 */
+
+		void Reset();
+
+		/**
+		 * <summary> Finds slot of the match index.</summary>
+		 *
+		 * <param name="matchIndex"> The match index.</param>
+		 *
+		 * <returns> The slot, -1 if the index is not in the history.</returns>
+		 */
+
+		short Find(int matchIndex) const;
+
+		/**
+		 * <summary> Gets match index of the slot.</summary>
+		 *
+		 * <param name="slot"> The slot.</param>
+		 *
+		 * <returns> The match index (zero if the slot is empty).</returns>
+		 */
+
+		int Get(short slot) const;
+
+		/**
+		 * <summary> Moves the match index to the front of history - the oldest one drops out if the index is new.</summary>
+		 *
+		 * <param name="matchIndex"> The match index.</param>
+		 */
+
+		void Update(int matchIndex);
+
+	private:
+		int matchIndices[Count];	///< The last match indices
+};
+
+
+inline short RepeatOffsets::Find(int matchIndex) const
+{
+	for (short i = 0; i < Count; i++)
+	{
+		if (matchIndices[i] == matchIndex)
+			return i;
+	}
+
+	return -1;
+}
+
+inline int RepeatOffsets::Get(short slot) const
+{
+	return matchIndices[slot];
+}
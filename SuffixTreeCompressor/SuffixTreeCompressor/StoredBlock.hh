@@ -0,0 +1,142 @@
+#pragma once
+
+#include <math.h>
+#include "Stream.hh"
+
+/**
+ * <summary> Helpers for blocks that are stored without compression. Such block is written as zero-length match with
+ *  MarkerIndex, its length and raw symbols. It ends the current group of flags and its symbols don't enter the sliding
+ *  window - neither the compressor nor the decoder uses them for matches. The exception is windowed block (WindowedBit
+ *  in the first length byte) that replaces chunk which expanded in the suffix tree - its symbols went through the tree
+ *  already, so the decoder puts them into the sliding window too.</summary>
+ */
+
+ //Declaration----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+class StoredBlock
+{
+	public:
+		static const int MarkerIndex = 9;			///< Index of zero-length match that marks stored block (end of data uses indices 0-7, long-range reference 8)
+		static const short ExtraBytesCount = 4;		///< Bytes behind the marker - number of stored symbols
+		static const uchar WindowedBit = 0x80;		///< Bit of the first length byte that marks windowed block
+
+		/**
+		 * <summary> Checks whether stored blocks fit the format - the marker index has to fit into match index. Symbols of any
+		 *  size can be stored.</summary>
+		 *
+		 * <param name="windowSize"> Size of the sliding window.</param>
+		 *
+		 * <returns> True if stored blocks can be used.</returns>
+		 */
+
+		static bool IsAvailable(int windowSize);
+
+		/**
+		 * <summary> Estimates size of literal of the symbols after entropy coding - their order-0 entropy rounded. Wider
+		 *  symbols are coded by buckets, so they keep their size.</summary>
+		 *
+		 * <param name="symbols"> The symbols.</param>
+		 * <param name="length">  Number of symbols.</param>
+		 *
+		 * <returns> Bits of one literal.</returns>
+		 */
+
+		static short EntropyCodedLiteralBits(const T * symbols, int length);
+
+		/**
+		 * <summary> Encode length of the block into bytes behind the marker.</summary>
+		 *
+		 * <param name="length">   The length.</param>
+		 * <param name="bytes">    The bytes (ExtraBytesCount).</param>
+		 * <param name="windowed"> Whether the symbols enter the sliding window.</param>
+		 */
+
+		static void EncodeLength(int length, uchar * bytes, bool windowed = false);
+
+		/**
+		 * <summary> Decode length of the block from bytes behind the marker.</summary>
+		 *
+		 * <param name="bytes"> The bytes (ExtraBytesCount).</param>
+		 *
+		 * <returns> The length.</returns>
+		 */
+
+		static int DecodeLength(const uchar * bytes);
+
+		/**
+		 * <summary> Checks whether the block is windowed - its symbols enter the sliding window.</summary>
+		 *
+		 * <param name="bytes"> The bytes behind the marker (ExtraBytesCount).</param>
+		 *
+		 * <returns> True if the block is windowed.</returns>
+		 */
+
+		static bool IsWindowed(const uchar * bytes);
+};
+
+//Definition----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+bool StoredBlock<T>::IsAvailable(int windowSize)
+{
+	return 2 * windowSize > MarkerIndex;
+}
+
+template <typename T>
+short StoredBlock<T>::EntropyCodedLiteralBits(const T * symbols, int length)
+{
+	if (sizeof(T) != 1 || length == 0)
+		return 8 * sizeof(T);
+
+	int counts[256] = { 0 };
+	for (int i = 0; i < length; i++)
+	{
+		counts[(uchar)symbols[i]]++;
+	}
+
+	double entropy = 0;
+	for (int i = 0; i < 256; i++)
+	{
+		if (counts[i] > 0)
+		{
+			double probability = (double)counts[i] / length;
+			entropy -= probability * log2(probability);
+		}
+	}
+
+	//Huffman code takes at least one bit per literal, else it is close to the entropy
+	return (entropy < 1) ? 1 : (short)(entropy + 0.5);
+}
+
+template <typename T>
+void StoredBlock<T>::EncodeLength(int length, uchar * bytes, bool windowed)
+{
+	for (short i = 0; i < ExtraBytesCount; i++)
+	{
+		bytes[i] = (length >> ((ExtraBytesCount - 1 - i) * 8)) & 0xff;
+	}
+
+	if (windowed)
+	{
+		bytes[0] |= WindowedBit;
+	}
+}
+
+template <typename T>
+int StoredBlock<T>::DecodeLength(const uchar * bytes)
+{
+	int length = bytes[0] & ~WindowedBit;
+	for (short i = 1; i < ExtraBytesCount; i++)
+	{
+		length = (length << 8) | bytes[i];
+	}
+
+	return length;
+}
+
+template <typename T>
+bool StoredBlock<T>::IsWindowed(const uchar * bytes)
+{
+	return (bytes[0] & WindowedBit) != 0;
+}
@@ -1,14 +1,19 @@
 #pragma once
 #include <stdlib.h>
 #include <fstream>
+#include <vector>
+#include <string.h>
+#include <algorithm>
+#include "BitStream.h"
+#include "Crc32c.h"
 
 using namespace std;
 
 /**
- * <summary> Class that represents reader from file.</summary>
+ * <summary> Class that represents reader from file. Compressed data are read as bit fields from buffer that is refilled
+ *  only by FillBits, so reading of one field has no branch.</summary>
  */
 
-typedef unsigned char uchar;
 //Declaration----------------------------------------------------------------------------------------------------------------------------------------------------------
 
 template <typename T> 
@@ -16,11 +21,17 @@ class InStream
 {
 	private:
 		ifstream inFile;		///< Input file to read from
-		int bytesRead;			///< The bytes currently read from file
+		long long bytesRead;	///< The bytes currently read from file
 		bool compression;		///< Flag if compression/decompression is happening
 		T symbol;			///< The symbol read
+		vector<uchar> bitBuffer;	///< Compressed data that are read as bits (followed by zero padding)
+		long long bufferedBytes;	///< Number of bytes of file in bitBuffer
+		BitReader bitReader;	///< The reader of bitBuffer
 
 	public:
+		static const int BitBufferSize = 1 << 16;	///< Number of bytes of file in full bitBuffer
+		static const int MaxFieldsBytes = 4096;		///< Bytes that have to be buffered before reading of one group of items
+
 		InStream() = default;
 		~InStream() = default;
 
@@ -36,12 +47,44 @@ class InStream
 		void Open(const char* fileName, bool compression, bool binaryFile = false);
 
 		/**
-		 * <summary> Reads byte while compression.</summary>
+		 * <summary> Makes sure that at least MaxFieldsBytes of compressed data are buffered (or the rest of file).</summary>
+		 */
+
+		void FillBits();
+
+		/**
+		 * <summary> Reads bit field of compressed data - FillBits has to be called before every group of fields.</summary>
+		 *
+		 * <param name="count"> Number of bits (0-64).</param>
+		 *
+		 * <returns> The value.</returns>
+		 */
+
+		unsigned long long ReadBits(short count);
+
+		/**
+		 * <summary> Gets the reader of buffered compressed data - the same rules as for ReadBits apply.</summary>
+		 *
+		 * <returns> The bit reader.</returns>
+		 */
+
+		BitReader & GetBitReader();
+
+		/**
+		 * <summary> Skips the rest of the current byte of compressed data.</summary>
+		 */
+
+		void AlignToByte();
+
+		/**
+		 * <summary> Reads whole bytes of compressed data - the position has to be at byte border. Bytes that are not buffered
+		 *  are read from file right away.</summary>
 		 *
-		 * <returns> The byte.</returns>
+		 * <param name="bytes"> The array for the bytes.</param>
+		 * <param name="count"> Number of bytes.</param>
 		 */
 
-		uchar ReadByte();
+		void ReadBytes(uchar * bytes, long long count);
 
 		/**
 		 * <summary> Reads single symbol from file.</summary>
@@ -52,12 +95,23 @@ class InStream
 		T ReadSymbol();
 
 		/**
-		* <summary> Reads single symbol from file in binary mode.</summary>
+		* <summary> Reads raw symbols from file in bulk (in the memory order of T - used for byte symbols).</summary>
 		*
-		* <returns> The symbol read from file.</returns>
+		* <param name="symbols"> The array for the symbols.</param>
+		* <param name="count">	  The maximal number of symbols to read.</param>
+		*
+		* <returns> Number of symbols read (zero at the end of file).</returns>
+		*/
+
+		int ReadSymbols(T * symbols, int count);
+
+		/**
+		* <summary> Moves to the given byte of the file - the bytes before are not read.</summary>
+		*
+		* <param name="position"> Position of the byte.</param>
 		*/
 
-		T ReadSymbolBin();
+		void Seek(long long position);
 
 		/**
 		 * <summary> Gets bytes read from file up to now.</summary>
@@ -65,7 +119,7 @@ class InStream
 		 * <returns> The bytes read.</returns>
 		 */
 
-		int GetBytesRead();
+		long long GetBytesRead();
 
 		/**
 		 * <summary> Closes the resource that I read from.</summary>
@@ -87,11 +141,27 @@ class OutStream
 {
 	private:
 		ofstream outFile;   ///< Output file to write to
-		int bytesWritten;   ///< The bytes currently written to file
+		long long bytesWritten;   ///< The bytes currently written to file
 		bool compression;   ///< Flag if compression/decompression is happening
 		bool binaryFile;	///< Whether the output file is binary
+		vector<uchar> pendingBytes;	///< Whole bytes of bit fields that are not written to file yet
+		BitWriter bitWriter;	///< The writer of bit fields into pendingBytes
+		bool checksumming;		///< Whether the written bytes are checksummed
+		Crc32c checksum;		///< Checksum of the bytes written since StartChecksum or TakeChecksum
+		size_t checksummedBytes;	///< Number of pendingBytes that are in checksum
+		bool marked;			///< Whether the position is marked - pending bytes are kept until the mark is released
+		size_t markedBytes;		///< Number of pendingBytes at the mark
+		BitWriter markedWriter;	///< The writer of bit fields at the mark
+
+		/**
+		 * <summary> Writes the pending bytes to file.</summary>
+		 */
+
+		void WritePendingBytes();
 
 	public:
+		static const int PendingBytesLimit = 1 << 16;	///< Number of pending bytes that are written to file at once
+
 		OutStream() = default;
 		~OutStream() = default;
 
@@ -107,13 +177,70 @@ class OutStream
 		void Open(const char* fileName, bool compression, bool binaryFile = false);
 
 		/**
-		* <summary> Writes a match byte to file.</summary>
+		 * <summary> Writes bit field of compressed data.</summary>
+		 *
+		 * <param name="value"> The value - only the lowest count bits may be set.</param>
+		 * <param name="count"> Number of bits (0-64).</param>
+		 */
+
+		void WriteBits(unsigned long long value, short count);
+
+		/**
+		* <summary> Writes a byte of compressed data (it doesn't have to start at byte border).</summary>
 		*
-		* <param name="symbol"> The symbol to write.</param>
+		* <param name="byte"> The byte to write.</param>
 		*/
 
 		void WriteByte(uchar byte);
 
+		/**
+		 * <summary> Fills the rest of the current byte of compressed data with zero bits.</summary>
+		 */
+
+		void AlignToByte();
+
+		/**
+		 * <summary> Writes whole bytes of compressed data - the position has to be at byte border.</summary>
+		 *
+		 * <param name="bytes"> The bytes to write.</param>
+		 */
+
+		void WriteBytes(const vector<uchar> & bytes);
+
+		/**
+		 * <summary> Starts checksum of compressed data - the bytes written before are not included.</summary>
+		 */
+
+		void StartChecksum();
+
+		/**
+		 * <summary> Gets checksum of compressed data written since StartChecksum or the last call and starts new one. The
+		 *  position has to be at byte border.</summary>
+		 *
+		 * <returns> CRC32C of the bytes.</returns>
+		 */
+
+		unsigned int TakeChecksum();
+
+		/**
+		 * <summary> Marks the current position, so that the data written behind it can be taken back. The bytes stay pending
+		 *  until the mark is released.</summary>
+		 */
+
+		void SetMark();
+
+		/**
+		 * <summary> Takes back the data written since the mark - the mark stays set.</summary>
+		 */
+
+		void RewindToMark();
+
+		/**
+		 * <summary> Releases the mark, the data written behind it can't be taken back anymore.</summary>
+		 */
+
+		void ReleaseMark();
+
 		/**
 		 * <summary> Writes single symbol to file.</summary>
 		 *
@@ -123,15 +250,15 @@ class OutStream
 		void WriteSymbol(T symbol);
 
 		/**
-		 * <summary> Gets bytes written to file up to now.</summary>
+		 * <summary> Gets bytes written to file up to now (including the bytes of bit fields that are still pending).</summary>
 		 *
 		 * <returns> The bytes written.</returns>
 		 */
 
-		int GetBytesWritten();
+		long long GetBytesWritten();
 
 		/**
-		 * <summary> Closes the resource that I write to.</summary>
+		 * <summary> Closes the resource that I write to - the last bits are padded to whole byte.</summary>
 		 *
 		 * <remarks> Jirka, 16. 3. 2018.</remarks>
 		 */
@@ -156,15 +283,65 @@ void InStream<T>::Open(const char* fileName, bool compression, bool binaryFile)
 
 	inFile >> noskipws;
 	this->compression = compression;
+	this->bitBuffer.assign(BitBufferSize + MaxFieldsBytes + BitReader::PaddingBytes, 0);
+	this->bufferedBytes = 0;
+	this->bitReader = BitReader(bitBuffer.data());
 }
 
-template<typename T>
-uchar InStream<T>::ReadByte()
+template <typename T>
+void InStream<T>::FillBits()
 {
-	uchar byte;
-	byte = inFile.get();
-	this->bytesRead++;
-	return byte;
+	long long position = bitReader.GetBitPosition() >> 3;
+	if (bufferedBytes - position >= MaxFieldsBytes || inFile.eof())
+		return;
+
+	//unread bytes move to the front, the padding behind the data stays zero
+	long long keptBytes = (bufferedBytes > position) ? bufferedBytes - position : 0;
+	memmove(bitBuffer.data(), bitBuffer.data() + position, keptBytes);
+	inFile.read(reinterpret_cast<char *>(bitBuffer.data() + keptBytes), BitBufferSize);
+	bufferedBytes = keptBytes + inFile.gcount();
+	this->bytesRead += inFile.gcount();
+	fill(bitBuffer.begin() + bufferedBytes, bitBuffer.end(), 0);
+
+	bitReader = BitReader(bitBuffer.data(), bitReader.GetBitPosition() & 7);
+}
+
+template <typename T>
+inline unsigned long long InStream<T>::ReadBits(short count)
+{
+	return bitReader.Read(count);
+}
+
+template <typename T>
+inline BitReader & InStream<T>::GetBitReader()
+{
+	return bitReader;
+}
+
+template <typename T>
+void InStream<T>::AlignToByte()
+{
+	bitReader.Skip((8 - (bitReader.GetBitPosition() & 7)) & 7);
+}
+
+template <typename T>
+void InStream<T>::ReadBytes(uchar * bytes, long long count)
+{
+	long long position = bitReader.GetBitPosition() >> 3;
+	long long bufferedCount = min(count, max(bufferedBytes - position, 0LL));
+	memcpy(bytes, bitBuffer.data() + position, bufferedCount);
+	bitReader.Skip(8 * bufferedCount);
+
+	if (bufferedCount < count)
+	{
+		inFile.read(reinterpret_cast<char *>(bytes + bufferedCount), count - bufferedCount);
+		this->bytesRead += inFile.gcount();
+
+		//the buffer is empty, the next FillBits reads behind the bytes
+		bufferedBytes = 0;
+		fill(bitBuffer.begin(), bitBuffer.end(), 0);
+		bitReader = BitReader(bitBuffer.data());
+	}
 }
 
 template <typename T>
@@ -180,21 +357,28 @@ T InStream<T>::ReadSymbol()
 	return symbol;
 }
 
-template<typename T>
-inline T InStream<T>::ReadSymbolBin()
+template <typename T>
+int InStream<T>::ReadSymbols(T * symbols, int count)
 {
-	inFile.read(reinterpret_cast<char *>(&symbol), sizeof symbol);
+	inFile.read(reinterpret_cast<char *>(symbols), (streamsize)count * sizeof(T));
 
-	if (!inFile.eof())
-	{
-		this->bytesRead += sizeof(T);
-	}
-	
-	return symbol;
+	int symbolsRead = inFile.gcount() / sizeof(T);
+	this->bytesRead += symbolsRead * sizeof(T);
+
+	return symbolsRead;
 }
 
 template <typename T>
-int InStream<T>::GetBytesRead()
+void InStream<T>::Seek(long long position)
+{
+	inFile.seekg(position);
+
+	bufferedBytes = 0;
+	bitReader = BitReader(bitBuffer.data());
+}
+
+template <typename T>
+long long InStream<T>::GetBytesRead()
 {
 	return bytesRead;
 }
@@ -230,14 +414,115 @@ void OutStream<T>::Open(const char * fileName, bool compression, bool binaryFile
 
 	this->compression = compression;
 	this->binaryFile = binaryFile;
+	this->pendingBytes.clear();
+	this->pendingBytes.reserve(PendingBytesLimit + 16);
+	this->bitWriter = BitWriter(&pendingBytes);
+	this->checksumming = false;
+	this->checksummedBytes = 0;
+	this->marked = false;
+}
+
+template <typename T>
+inline void OutStream<T>::WriteBits(unsigned long long value, short count)
+{
+	bitWriter.Write(value, count);
+
+	if (!marked && pendingBytes.size() >= PendingBytesLimit)
+	{
+		WritePendingBytes();
+	}
 }
 
 template<typename T>
 inline void OutStream<T>::WriteByte(uchar byte)
 {
-	outFile << byte;
+	WriteBits(byte, 8);
+}
+
+template <typename T>
+void OutStream<T>::AlignToByte()
+{
+	bitWriter.Flush();
+}
+
+template <typename T>
+void OutStream<T>::WriteBytes(const vector<uchar> & bytes)
+{
+	//the position is at byte border, so the bytes just follow the pending ones
+	if (marked)
+	{
+		pendingBytes.insert(pendingBytes.end(), bytes.begin(), bytes.end());
+		return;
+	}
+
+	WritePendingBytes();
+
+	outFile.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+	this->bytesWritten += bytes.size();
+
+	if (checksumming)
+	{
+		checksum.Update(bytes.data(), bytes.size());
+	}
+}
+
+template <typename T>
+void OutStream<T>::StartChecksum()
+{
+	checksumming = true;
+	checksum.Reset();
+	checksummedBytes = pendingBytes.size();
+}
+
+template <typename T>
+unsigned int OutStream<T>::TakeChecksum()
+{
+	checksum.Update(pendingBytes.data() + checksummedBytes, pendingBytes.size() - checksummedBytes);
+	checksummedBytes = pendingBytes.size();
+
+	unsigned int value = checksum.GetValue();
+	checksum.Reset();
+	return value;
+}
+
+template <typename T>
+void OutStream<T>::SetMark()
+{
+	marked = true;
+	markedBytes = pendingBytes.size();
+	markedWriter = bitWriter;
+}
+
+template <typename T>
+void OutStream<T>::RewindToMark()
+{
+	pendingBytes.resize(markedBytes);
+	bitWriter = markedWriter;
+}
+
+template <typename T>
+void OutStream<T>::ReleaseMark()
+{
+	marked = false;
+
+	if (pendingBytes.size() >= PendingBytesLimit)
+	{
+		WritePendingBytes();
+	}
+}
+
+template <typename T>
+void OutStream<T>::WritePendingBytes()
+{
+	if (checksumming)
+	{
+		checksum.Update(pendingBytes.data() + checksummedBytes, pendingBytes.size() - checksummedBytes);
+		checksummedBytes = 0;
+	}
 
-	this->bytesWritten++;
+	outFile.write(reinterpret_cast<char *>(pendingBytes.data()), pendingBytes.size());
+	this->bytesWritten += pendingBytes.size();
+	pendingBytes.clear();
 }
 
 template <typename T>
@@ -249,13 +534,15 @@ void OutStream<T>::WriteSymbol(T symbol)
 }
 
 template <typename T>
-int OutStream<T>::GetBytesWritten()
+long long OutStream<T>::GetBytesWritten()
 {
-	return this->bytesWritten;
+	return this->bytesWritten + pendingBytes.size();
 }
 
 template <typename T>
 void OutStream<T>::Close()
 {
+	AlignToByte();
+	WritePendingBytes();
 	this->outFile.close();
 }
\ No newline at end of file
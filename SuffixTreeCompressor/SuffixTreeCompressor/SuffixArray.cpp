@@ -0,0 +1,215 @@
+#include "SuffixArray.h"
+
+void SuffixArray::Build(const int * text, int * suffixArray, int length, int maxSymbol)
+{
+	if (length == 1)
+	{
+		suffixArray[0] = 0;
+		return;
+	}
+
+	//classify suffixes - the sentinel is S-type, the suffix in front of it L-type
+	bool * sType = new bool[length];
+	sType[length - 1] = true;
+	sType[length - 2] = false;
+	for (int i = length - 3; i >= 0; i--)
+	{
+		sType[i] = text[i] < text[i + 1] || (text[i] == text[i + 1] && sType[i + 1]);
+	}
+
+	//stage 1 - sort LMS substrings: put LMS suffixes to ends of their buckets and induce the rest
+	int * buckets = new int[maxSymbol + 1];
+	GetBuckets(text, buckets, length, maxSymbol, true);
+	for (int i = 0; i < length; i++)
+	{
+		suffixArray[i] = -1;
+	}
+	for (int i = 1; i < length; i++)
+	{
+		if (IsLms(sType, i))
+		{
+			suffixArray[--buckets[text[i]]] = i;
+		}
+	}
+	InduceL(sType, suffixArray, text, buckets, length, maxSymbol);
+	InduceS(sType, suffixArray, text, buckets, length, maxSymbol);
+
+	//move sorted LMS substrings to the beginning
+	int lmsCount = 0;
+	for (int i = 0; i < length; i++)
+	{
+		if (IsLms(sType, suffixArray[i]))
+		{
+			suffixArray[lmsCount++] = suffixArray[i];
+		}
+	}
+
+	//name LMS substrings - equal substrings get equal names; name of substring starting at p is stored at lmsCount + p / 2
+	for (int i = lmsCount; i < length; i++)
+	{
+		suffixArray[i] = -1;
+	}
+
+	int name = 0;
+	int previous = -1;
+	for (int i = 0; i < lmsCount; i++)
+	{
+		int position = suffixArray[i];
+		bool different = false;
+
+		for (int d = 0; d < length; d++)
+		{
+			if (previous == -1 || text[position + d] != text[previous + d] || sType[position + d] != sType[previous + d])
+			{
+				different = true;
+				break;
+			}
+			else if (d > 0 && (IsLms(sType, position + d) || IsLms(sType, previous + d)))
+			{
+				break;
+			}
+		}
+
+		if (different)
+		{
+			name++;
+			previous = position;
+		}
+
+		suffixArray[lmsCount + position / 2] = name - 1;
+	}
+
+	for (int i = length - 1, j = length - 1; i >= lmsCount; i--)
+	{
+		if (suffixArray[i] >= 0)
+		{
+			suffixArray[j--] = suffixArray[i];
+		}
+	}
+
+	//stage 2 - sort LMS suffixes, recursively if the names are not unique yet
+	int * reducedSuffixArray = suffixArray;
+	int * reducedText = suffixArray + length - lmsCount;
+
+	if (name < lmsCount)
+	{
+		Build(reducedText, reducedSuffixArray, lmsCount, name - 1);
+	}
+	else
+	{
+		for (int i = 0; i < lmsCount; i++)
+		{
+			reducedSuffixArray[reducedText[i]] = i;
+		}
+	}
+
+	//stage 3 - place sorted LMS suffixes to ends of their buckets and induce the whole suffix array
+	GetBuckets(text, buckets, length, maxSymbol, true);
+	for (int i = 1, j = 0; i < length; i++)
+	{
+		if (IsLms(sType, i))
+		{
+			reducedText[j++] = i;
+		}
+	}
+	for (int i = 0; i < lmsCount; i++)
+	{
+		reducedSuffixArray[i] = reducedText[reducedSuffixArray[i]];
+	}
+	for (int i = lmsCount; i < length; i++)
+	{
+		suffixArray[i] = -1;
+	}
+	for (int i = lmsCount - 1; i >= 0; i--)
+	{
+		int position = suffixArray[i];
+		suffixArray[i] = -1;
+		suffixArray[--buckets[text[position]]] = position;
+	}
+	InduceL(sType, suffixArray, text, buckets, length, maxSymbol);
+	InduceS(sType, suffixArray, text, buckets, length, maxSymbol);
+
+	delete[] buckets;
+	delete[] sType;
+}
+
+void SuffixArray::BuildLcp(const int * text, const int * suffixArray, int * rank, int * lcp, int length)
+{
+	for (int i = 0; i < length; i++)
+	{
+		rank[suffixArray[i]] = i;
+	}
+
+	//lcp of suffix i + 1 with its predecessor is at least lcp of suffix i minus one
+	int h = 0;
+	lcp[0] = 0;
+	for (int i = 0; i < length; i++)
+	{
+		if (rank[i] == 0)
+		{
+			h = 0;
+			continue;
+		}
+
+		int j = suffixArray[rank[i] - 1];
+		while (i + h < length && j + h < length && text[i + h] == text[j + h])
+		{
+			h++;
+		}
+
+		lcp[rank[i]] = h;
+		if (h > 0) h--;
+	}
+}
+
+void SuffixArray::GetBuckets(const int * text, int * buckets, int length, int maxSymbol, bool ends)
+{
+	for (int i = 0; i <= maxSymbol; i++)
+	{
+		buckets[i] = 0;
+	}
+	for (int i = 0; i < length; i++)
+	{
+		buckets[text[i]]++;
+	}
+
+	int sum = 0;
+	for (int i = 0; i <= maxSymbol; i++)
+	{
+		sum += buckets[i];
+		buckets[i] = ends ? sum : sum - buckets[i];
+	}
+}
+
+void SuffixArray::InduceL(const bool * sType, int * suffixArray, const int * text, int * buckets, int length, int maxSymbol)
+{
+	GetBuckets(text, buckets, length, maxSymbol, false);
+
+	for (int i = 0; i < length; i++)
+	{
+		int j = suffixArray[i] - 1;
+		if (j >= 0 && !sType[j])
+		{
+			suffixArray[buckets[text[j]]++] = j;
+		}
+	}
+}
+
+void SuffixArray::InduceS(const bool * sType, int * suffixArray, const int * text, int * buckets, int length, int maxSymbol)
+{
+	GetBuckets(text, buckets, length, maxSymbol, true);
+
+	for (int i = length - 1; i >= 0; i--)
+	{
+		int j = suffixArray[i] - 1;
+		if (j >= 0 && sType[j])
+		{
+			suffixArray[--buckets[text[j]]] = j;
+		}
+	}
+}
+
+bool SuffixArray::IsLms(const bool * sType, int position)
+{
+	return position > 0 && sType[position] && !sType[position - 1];
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+ * <summary> Suffix array construction by induced sorting (SA-IS) and LCP array construction (Kasai et al.).
+ *  Both work in linear time over integer alphabet.</summary>
+ */
+
+class SuffixArray
+{
+	public:
+		/**
+		 * <summary> Builds suffix array of the text. The text must end with a unique sentinel 0, all other symbols must be positive.</summary>
+		 *
+		 * <param name="text">		   The text.</param>
+		 * <param name="suffixArray">  The suffix array (output, length items).</param>
+		 * <param name="length">	   Length of the text including the sentinel.</param>
+		 * <param name="maxSymbol">	   The maximal symbol of the text.</param>
+		 */
+
+		static void Build(const int * text, int * suffixArray, int length, int maxSymbol);
+
+		/**
+		 * <summary> Builds LCP array - lcp[i] is the length of the longest common prefix of suffixes suffixArray[i - 1] and suffixArray[i].</summary>
+		 *
+		 * <param name="text">		   The text ending with a unique sentinel.</param>
+		 * <param name="suffixArray">  The suffix array.</param>
+		 * <param name="rank">		   Auxiliary array for inverse suffix array (length items).</param>
+		 * <param name="lcp">		   The LCP array (output, length items).</param>
+		 * <param name="length">	   Length of the text including the sentinel.</param>
+		 */
+
+		static void BuildLcp(const int * text, const int * suffixArray, int * rank, int * lcp, int length);
+
+	private:
+		/**
+		 * <summary> Gets starts or ends of buckets of all symbols.</summary>
+		 *
+		 * <param name="text">	    The text.</param>
+		 * <param name="buckets">   The buckets (output, maxSymbol + 1 items).</param>
+		 * <param name="length">    Length of the text.</param>
+		 * <param name="maxSymbol"> The maximal symbol.</param>
+		 * <param name="ends">	    True for bucket ends, false for bucket starts.</param>
+		 */
+
+		static void GetBuckets(const int * text, int * buckets, int length, int maxSymbol, bool ends);
+
+		/**
+		 * <summary> Induces L-type suffixes from the sorted suffixes already placed in the suffix array.</summary>
+		 */
+
+		static void InduceL(const bool * sType, int * suffixArray, const int * text, int * buckets, int length, int maxSymbol);
+
+		/**
+		 * <summary> Induces S-type suffixes from the sorted suffixes already placed in the suffix array.</summary>
+		 */
+
+		static void InduceS(const bool * sType, int * suffixArray, const int * text, int * buckets, int length, int maxSymbol);
+
+		/**
+		 * <summary> Check if suffix is leftmost S-type one (S-type with L-type on the left).</summary>
+		 */
+
+		static bool IsLms(const bool * sType, int position);
+};
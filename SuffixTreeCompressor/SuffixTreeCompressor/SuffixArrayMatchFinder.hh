@@ -0,0 +1,163 @@
+#pragma once
+#include <algorithm>
+
+#include "MatchFinder.hh"
+#include "SuffixArray.h"
+
+using namespace std;
+
+/**
+ * <summary> Block match finder built on suffix array and LCP array. For every suffix, the longest match with an earlier
+ *  position is given by its nearest neighbours in the suffix array that start before it (previous and next smaller value),
+ *  both are found in one pass with a stack.</summary>
+ */
+
+ //Declaration----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+class SuffixArrayMatchFinder : public MatchFinder<T>
+{
+	public:
+		SuffixArrayMatchFinder(int capacity);
+		~SuffixArrayMatchFinder();
+
+		void FindMatches(const T * symbols, int historyLength, int length, int * matchLengths, int * matchDistances);
+
+	private:
+		int capacity;			///< Maximal number of symbols (history and block) in one call
+		int * text;				///< The symbols mapped to positive integers, followed by the sentinel
+		int * suffixArray;		///< The suffix array of text
+		int * rank;				///< Inverse suffix array; reused as stack of positions afterwards
+		int * lcp;				///< The LCP array
+		int * stackLcp;			///< For every position in the stack: LCP with the position below it
+		T * sortedSymbols;		///< Distinct symbols of the block (used if symbols are too big to index buckets directly)
+
+		/**
+		 * <summary> Maps symbols to the integer text for suffix array construction.</summary>
+		 *
+		 * <param name="symbols"> The symbols.</param>
+		 * <param name="length">  Number of symbols.</param>
+		 *
+		 * <returns> The maximal symbol of the text.</returns>
+		 */
+
+		int MapSymbols(const T * symbols, int length);
+};
+
+//Definition----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+SuffixArrayMatchFinder<T>::SuffixArrayMatchFinder(int capacity)
+{
+	this->capacity = capacity;
+	this->text = new int[capacity + 1];
+	this->suffixArray = new int[capacity + 1];
+	this->rank = new int[capacity + 1];
+	this->lcp = new int[capacity + 1];
+	this->stackLcp = new int[capacity + 1];
+	this->sortedSymbols = new T[capacity];
+}
+
+template <typename T>
+SuffixArrayMatchFinder<T>::~SuffixArrayMatchFinder()
+{
+	delete[] text;
+	delete[] suffixArray;
+	delete[] rank;
+	delete[] lcp;
+	delete[] stackLcp;
+	delete[] sortedSymbols;
+}
+
+template <typename T>
+void SuffixArrayMatchFinder<T>::FindMatches(const T * symbols, int historyLength, int length, int * matchLengths, int * matchDistances)
+{
+	if (length == 0)
+		return;
+
+	int maxSymbol = MapSymbols(symbols, length);
+	SuffixArray::Build(text, suffixArray, length + 1, maxSymbol);
+	SuffixArray::BuildLcp(text, suffixArray, rank, lcp, length + 1);
+
+	//suffixArray[0] is the sentinel; position -1 at the end pops all remaining suffixes (they have no next smaller value)
+	int * stack = rank;
+	int stackSize = 0;
+
+	for (int r = 1; r <= length + 1; r++)
+	{
+		int position = (r <= length) ? suffixArray[r] : -1;
+		int currentLcp = (r <= length) ? lcp[r] : 0;
+
+		while (stackSize > 0 && stack[stackSize - 1] > position)
+		{
+			stackSize--;
+			int popped = stack[stackSize];
+			int previousLcp = stackLcp[stackSize];
+
+			if (popped >= historyLength)
+			{
+				int source = -1;
+				int matchLength = 0;
+
+				//take the longer one, the closer one if they are equally long
+				if (previousLcp > 0)
+				{
+					source = stack[stackSize - 1];
+					matchLength = previousLcp;
+				}
+				if (currentLcp > matchLength || (currentLcp == matchLength && currentLcp > 0 && position > source))
+				{
+					source = position;
+					matchLength = currentLcp;
+				}
+
+				matchLengths[popped - historyLength] = matchLength;
+				matchDistances[popped - historyLength] = (matchLength > 0) ? popped - source : 0;
+			}
+
+			//LCP of the current suffix with the new top is the minimum over the range between them
+			currentLcp = min(currentLcp, previousLcp);
+		}
+
+		if (position < 0)
+			break;
+
+		stackLcp[stackSize] = (stackSize > 0) ? currentLcp : 0;
+		stack[stackSize++] = position;
+	}
+}
+
+template <typename T>
+int SuffixArrayMatchFinder<T>::MapSymbols(const T * symbols, int length)
+{
+	T maxSymbol = 0;
+	for (int i = 0; i < length; i++)
+	{
+		if (symbols[i] > maxSymbol)
+			maxSymbol = symbols[i];
+	}
+
+	if ((unsigned long long)maxSymbol < (unsigned long long)capacity)
+	{
+		for (int i = 0; i < length; i++)
+		{
+			text[i] = (int)symbols[i] + 1;
+		}
+		text[length] = 0;
+
+		return (int)maxSymbol + 1;
+	}
+
+	//too big symbols (big token dictionary) - use their ranks among distinct symbols of the block
+	copy(symbols, symbols + length, sortedSymbols);
+	sort(sortedSymbols, sortedSymbols + length);
+	int distinctCount = (int)(unique(sortedSymbols, sortedSymbols + length) - sortedSymbols);
+
+	for (int i = 0; i < length; i++)
+	{
+		text[i] = (int)(lower_bound(sortedSymbols, sortedSymbols + distinctCount, symbols[i]) - sortedSymbols) + 1;
+	}
+	text[length] = 0;
+
+	return distinctCount;
+}
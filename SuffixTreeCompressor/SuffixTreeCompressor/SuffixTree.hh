@@ -2,8 +2,10 @@
 
 #include <string>
 #include <chrono>
+#include <iomanip>
 #include "ActivePoint.h"
 #include "Vertex.hh"
+#include "VertexPool.hh"
 #include "Leaf.h"
 #include "Buffer.hh"
 #include "MatchHelper.hh"
@@ -11,19 +13,27 @@
 #include "Encoder.h"
 #include "Decoder.h"
 #include "OutputBytesHelper.hh"
+#include "LongRangeMatcher.hh"
+#include "StoredBlock.hh"
+#include "Reference.hh"
+#include "CompressionStrategy.h"
+#include "TimeBudget.h"
+#include "BlockIndex.h"
 #include "SuffixTreeAux.hh"
+#include "HugePageAllocator.h"
 #include "TokenInputStream.h"
 #include "TokenOutputStream.h"
 
 using namespace std;
 
 /**
- * <summary> The suffix tree itself.</summary>
+ * <summary> The suffix tree itself. If WindowBits is nonzero, the tree is specialized for that window size - buffer masks,
+ *  match length bits and match bytes count are compile-time constants. Zero means the generic tree configured at run time.</summary>
  */
 
  //Declaration----------------------------------------------------------------------------------------------------------------------------------------------------------
 
-template <typename T> 
+template <typename T, int WindowBits = 0>
 class SuffixTree : public SuffixTreeAux
 {
 	public:
@@ -37,19 +47,97 @@ class SuffixTree : public SuffixTreeAux
 		 * <param name="outFile">			  The output file.</param>
 		 * <param name="matchLengthSizeBits"> The number of bits that are occupied by match length.</param>
 		 * <param name="binaryFile">		  Compressing binary file.</param>
+		 * <param name="compactTree">		  Periodically renumber vertices in DFS order to keep them close in memory.</param>
+		 * <param name="longRange">			  Find repetitions beyond the sliding window in a pre-pass over the whole input.</param>
+		 * <param name="repeatOffsets">		  Matches that reuse one of the last match indices get short repeat codes.</param>
+		 * <param name="sequences">			  Write items in sequence layout instead of groups of flags.</param>
+		 * <param name="splitStreams">		  Write flags, literals and matches as separate sub-streams of every block.</param>
 		 */
 
-		void InitForCompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile);
+		void InitForCompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile, bool compactTree, bool longRange, bool repeatOffsets, bool sequences, bool splitStreams);
 
 		/**
-		 * <summary> Initializes for decompression.</summary>
+		 * <summary> Initializes for decompression - it can be called again after Decompress, so that one decompressor decodes
+		 *  more parts of the file one by one.</summary>
 		 *
 		 * <param name="inFile">			  The input file.</param>
-		 * <param name="outFile">			  The output file.</param>
+		 * <param name="outFile">			  The output file (NULL to decode without output).</param>
 		 * <param name="matchLengthSizeBits"> The number of bits that are occupied by match length.</param>
+		 * <param name="longRange">			  Keep the whole output to resolve long-range references.</param>
+		 * <param name="repeatOffsets">		  Matches may have repeat codes.</param>
+		 * <param name="sequences">			  Items are in sequence layout.</param>
+		 * <param name="splitStreams">		  Items are in split layout.</param>
+		 */
+
+		void InitForDecompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile, bool longRange, bool repeatOffsets, bool sequences, bool splitStreams);
+
+		/**
+		 * <summary> Loads the reference file - the input is compressed as changes against it.</summary>
+		 *
+		 * <param name="referenceFile">   The reference file.</param>
+		 * <param name="referenceTokens"> Tokens of the reference (NULL in byte mode).</param>
+		 */
+
+		void LoadReference(const char * referenceFile, const vector<int> * referenceTokens);
+
+		/**
+		 * <summary> Skips the beginning of the input file - it was compressed by an earlier run.</summary>
+		 *
+		 * <param name="bytes"> Number of bytes to skip.</param>
+		 */
+
+		void SkipInput(long long bytes);
+
+		/**
+		 * <summary> Writes header of the compressed file - symbol width and block size are filled in.</summary>
+		 *
+		 * <param name="header"> The header with parameters of compression.</param>
+		 */
+
+		void WriteFrameHeader(FrameHeader header);
+
+		/**
+		 * <summary> Splits the input into independent blocks - every block starts with empty window, so it can be decoded
+		 *  alone. The index of blocks is written behind the compressed data.</summary>
+		 *
+		 * <param name="blockSymbols"> Number of symbols per block.</param>
+		 */
+
+		void SetIndependentBlocks(int blockSymbols);
+
+		/**
+		 * <summary> Sets number of independent blocks to decode - decoding stops at the end mark of the last one.</summary>
+		 *
+		 * <param name="count"> The blocks count.</param>
+		 */
+
+		void SetBlocksToDecode(int count);
+
+		/**
+		 * <summary> Sets whether blocks have checksums - the compressor writes them to the block index (the whole input is
+		 *  one block if it is not split), the decompressor computes checksum of every decoded block.</summary>
+		 *
+		 * <param name="checksums"> True to use checksums.</param>
+		 */
+
+		void SetChecksums(bool checksums);
+
+		/**
+		 * <summary> Sets whether the output is entropy coded afterwards - literals of measured chunks are counted by estimate
+		 *  of their entropy coded size.</summary>
+		 *
+		 * <param name="entropyCoding"> True if the output is entropy coded.</param>
+		 */
+
+		void SetEntropyCoding(bool entropyCoding);
+
+		/**
+		 * <summary> Gets checksums of the decoded blocks.</summary>
+		 *
+		 * <returns> CRC32C of symbols of every decoded block.</returns>
 		 */
 
-		void InitForDecompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile);
+		const vector<unsigned int>& GetDecodedChecksums() const;
 
 		/**
 		 * <summary> Finishes a compression.</summary>
@@ -68,18 +156,21 @@ class SuffixTree : public SuffixTreeAux
 		 *
 		 * <param name="inputFileSize"> Size of the input file.</param>
 		 * <param name="showProgress">  True to show, false to hide the progress.</param>
+		 * <param name="inputStream">	 The tokens to compress - NULL to compress raw symbols of the input file.</param>
+		 * <param name="timeBudget">	 Time budget in seconds (zero if none) - when it is at risk, the rest is stored.</param>
 		 */
 
-		void Compress(long int inputFileSize, bool showProgress, TokenInputStream * inputStream);
+		void Compress(long long inputFileSize, bool showProgress, TokenInputStream * inputStream, double timeBudget);
 
 		/**
 		 * <summary> Do the decompression.</summary>
 		 *
 		 * <param name="inputFileSize"> Size of the input file.</param>
 		 * <param name="showProgress">  True to show, false to hide the progress.</param>
+		 * <param name="outputStream">  The stream to write tokens to - NULL to write raw symbols to the output file.</param>
 		 */
 
-		void Decompress(long int inputFileSize, bool showProgress, TokenOutputStream* outputStream);
+		void Decompress(long long inputFileSize, bool showProgress, TokenOutputStream* outputStream);
 
 		/**
 		 * <summary> Writes the suffix tree.</summary>
@@ -101,14 +192,17 @@ class SuffixTree : public SuffixTreeAux
 
 	private:
 		Match match;				///< Global match that is sent to MatchHelper to get matches
-		short matchBytesCount;		///< Number of bytes per one match
-		uchar * matchBytes;			///< Global match bytes that are sent to MatchHelper to save bytes for current match
+		short matchBits;			///< Number of bits per one match (index in buffer and length)
+		short matchLengthBits;		///< Number of bits of match length field (longer matches are extended)
+		short matchBytesCount;		///< Number of bytes that match bits take rounded up - shorter matches go out as literals
 		T * shortMatch;				///< Global short match bytes (symbols) that are sent to MatchHelper; used when the match is too short
 		Vertex<T> * root;			///< The root of the suffix tree
+		VertexPool<T> * vertexPool;	///< The store for inner vertices
+		bool compactTree;			///< Whether vertices are renumbered in DFS order when front is on the edge
 		VertexChild * bot;			///< The bot of the suffix tree
 		Vertex<T> * lastVertexWithoutSuffixLinkEnd;	///< The last vertex that has no suffix link - there is no vertex at the end of the link
 		ActivePoint activePoint;	///< The active point, that moves through graph
-		Buffer<T> * buffer;			///< The buffer for underlying string
+		Buffer<T, WindowBits> * buffer;	///< The buffer for underlying string
 		Leaf * leaves;				///< The suffix tree leaves
 		int windowSize;				///< Size of the sliding window
 		int newLeafIndex;			///< The index of the new leaf
@@ -121,8 +215,105 @@ class SuffixTree : public SuffixTreeAux
 		OutputBytesHelper<T> * outputBytesHelper;  ///< The helper for collecting output bytes
 
 		bool matchAfterLongestSufixRemoval;		///< Whether there is a match that stayed after longest suffix removal
-		int symbolsProcessed = 0;
+		LongRangeMatcher<T> * longRangeMatcher;	///< The pre-pass with long-range matches (NULL if not used)
+		uchar * longRangeBytes;					///< Distance and length bytes of the current long-range match
+		bool outputSuppressed;					///< Whether symbols are covered by long-range match - they go to the tree, but not to the output
+		long long longRangeMatchEnd;			///< Position behind the current long-range match
+		bool keepHistory;						///< Whether all decoded symbols are kept for long-range references
+		vector<T> history;						///< All decoded symbols
+		T * rawSymbols;							///< Raw symbols read from the input file in bulk (when compressing without tokens)
+		int rawSymbolsCount;					///< Number of symbols in rawSymbols
+		int rawSymbolsPosition;					///< Position of the next symbol in rawSymbols
+		long long rawSymbolsRead;				///< Number of raw symbols read from the input file
+		bool storedBlocks;						///< Whether chunks whose output expanded are stored instead
+		T * chunkSymbols;						///< Symbols of the current chunk
+		int chunkLength;						///< Number of symbols of the current chunk
+		long long chunkStartBits;				///< Appended bits of the output in front of the current chunk
+		bool chunkStorable;						///< Whether the current chunk started outside long-range match - only such chunk can be stored
+		Encoder chunkStartEncoder;				///< The encoder (its repeat offsets) in front of the current chunk
+		T * storedSymbols;						///< Chunk of symbols that is stored after the time budget got at risk
+		StrategyLog chunkStrategies;			///< Strategy of every chunk (RawChunkSize symbols)
+		bool showStrategies;					///< Whether strategies are reported in statistics
+		vector<T> reference;					///< Symbols of the reference file (empty if not used)
+		int blockSymbols;						///< Number of symbols per independent block (zero if the input is not split)
+		long long nextBlockStart;				///< Position of the first symbol of the next independent block
+		BlockIndex blockIndex;					///< Where the independent blocks start
+		int blocksToDecode;						///< Number of independent blocks to decode
+		bool sequences;							///< Whether items are in sequence layout instead of groups of flags
+		bool splitStreams;						///< Whether items are in blocks of flags, literals and matches sub-streams
+		vector<uchar> splitFlags;				///< Flags sub-stream of the current split block
+		vector<uchar> splitLiterals;			///< Literals sub-stream of the current split block
+		vector<uchar> splitMatches;				///< Matches sub-stream of the current split block
+		bool checksums;							///< Whether blocks have checksums
+		bool entropyCoding;						///< Whether the output is entropy coded afterwards
+		Crc32c contentChecksum;					///< Checksum of symbols of the current block
+		vector<unsigned int> decodedChecksums;	///< Checksums of the decoded blocks
+		bool writeOutput;						///< Whether decoded symbols are written (not only checked)
+
+		static const int RawChunkSize = 1 << 16;	///< Number of raw symbols read at once (and the longest chunk)
+		long long symbolsProcessed = 0;
+
+		static const short FixedMatchLengthBits = 7 - WindowBits % 8;	///< Match length bits of the specialized tree
+		static const short FixedMatchBits = WindowBits + 1 + FixedMatchLengthBits;	///< Number of bits per one match of the specialized tree
+
+		/**
+		* <summary> Gets size of the sliding window.</summary>
+		*
+		* <returns> The window size.</returns>
+		*/
+
+		int WindowSize();
+
+		/**
+		* <summary> Gets size of the buffer (twice the window size).</summary>
+		*
+		* <returns> The buffer size.</returns>
+		*/
+
+		int BufferSize();
+
+		/**
+		* <summary> Gets number of bits per one match.</summary>
+		*
+		* <returns> The match bits.</returns>
+		*/
+
+		short MatchBits();
+
+		/**
+		* <summary> Gets number of bits of match length field.</summary>
+		*
+		* <returns> The match length bits.</returns>
+		*/
+
+		short MatchLengthBits();
+
+		/**
+		* <summary> Encode match into bit field.</summary>
+		*
+		* <param name="match"> Specifies the match.</param>
+		*
+		* <returns> The match code.</returns>
+		*/
+
+		unsigned long long EncodeMatch(Match match);
+
+		/**
+		* <summary> Decode match from bit field.</summary>
+		*
+		* <param name="code"> The match code.</param>
+		*
+		* <returns> A decoded match.</returns>
+		*/
+
+		Match DecodeMatch(unsigned long long code);
 		
+		/**
+		* <summary> Writes whether big arrays got huge pages.</summary>
+		*/
+
+		void WriteHugePagesStatistics();
+
 		/**
 		* <summary> Creates empty graph.</summary>
 		*/
@@ -217,6 +408,216 @@ class SuffixTree : public SuffixTreeAux
 
 		void WriteMatch();
 
+		/**
+		 * <summary> Moves the current match to one of the last match indices if the same symbols are there - repeat code is
+		 *  shorter than full match code.</summary>
+		 *
+		 * <param name="matchStart"> Position of the first symbol of the match in buffer.</param>
+		 */
+
+		void PreferRepeatOffset(int matchStart);
+
+		/**
+		 * <summary> Reads the next token - from the long-range pre-pass if it is used, else from the input stream (or raw input
+		 *  file if there is no input stream).</summary>
+		 *
+		 * <param name="inputStream"> The input stream.</param>
+		 * <param name="token">		  The token.</param>
+		 *
+		 * <returns> False if there are no more tokens.</returns>
+		 */
+
+		bool ReadToken(TokenInputStream * inputStream, T & token);
+
+		/**
+		 * <summary> Writes out the pending match and the long-range match that starts at the current position, then
+		 *  suppresses output of the symbols it covers.</summary>
+		 */
+
+		void BeginLongRangeMatch();
+
+		/**
+		 * <summary> Drops the match that was found inside the long-range match and resumes output.</summary>
+		 */
+
+		void EndLongRangeMatch();
+
+		/**
+		 * <summary> Appends decoded symbol to the sliding window and writes it out.</summary>
+		 *
+		 * <param name="symbol">	   The symbol.</param>
+		 * <param name="outputStream"> The output stream.</param>
+		 */
+
+		void AppendDecodedSymbol(T symbol, TokenOutputStream * outputStream);
+
+		/**
+		 * <summary> Writes decoded symbol out (and to the history) - as token, or raw symbol if there is no output stream.</summary>
+		 *
+		 * <param name="symbol">	   The symbol.</param>
+		 * <param name="outputStream"> The output stream.</param>
+		 */
+
+		void WriteDecodedSymbol(T symbol, TokenOutputStream * outputStream);
+
+		/**
+		 * <summary> Reads bytes of length extension if the length field holds the escape value.</summary>
+		 *
+		 * <param name="match">		 The match (or literal run) whose length is extended.</param>
+		 * <param name="lengthBits"> The number of bits of length field.</param>
+		 * <param name="reader">	 The reader of the matches.</param>
+		 */
+
+		void ReadLengthExtension(Match & match, short lengthBits, BitReader & reader);
+
+		/**
+		 * <summary> Reads match code (repeat code or full one) with its length extension.</summary>
+		 *
+		 * <param name="reader"> The reader of the matches.</param>
+		 *
+		 * <returns> The match (zero length for markers).</returns>
+		 */
+
+		Match ReadMatch(BitReader & reader);
+
+		/**
+		 * <summary> Copies decoded match from the sliding window and writes it out.</summary>
+		 *
+		 * <param name="match">		   The match.</param>
+		 * <param name="outputStream"> The output stream.</param>
+		 */
+
+		void CopyMatch(Match match, TokenOutputStream * outputStream);
+
+		/**
+		 * <summary> Reads literal run of sequence and writes the literals out.</summary>
+		 *
+		 * <param name="outputStream"> The output stream.</param>
+		 *
+		 * <returns> The run length - MaxLiteralRun means that no match follows.</returns>
+		 */
+
+		int DecodeLiteralRun(TokenOutputStream * outputStream);
+
+		/**
+		 * <summary> Reads length of stored block behind its marker.</summary>
+		 *
+		 * <param name="reader">   The reader of the matches.</param>
+		 * <param name="windowed"> Whether the symbols enter the sliding window.</param>
+		 *
+		 * <returns> Number of raw symbols of the block.</returns>
+		 */
+
+		int ReadStoredBlockLength(BitReader & reader, bool & windowed);
+
+		/**
+		 * <summary> Reads stored block behind its marker (length and raw symbols) and writes it out.</summary>
+		 *
+		 * <param name="outputStream"> The output stream.</param>
+		 */
+
+		void DecodeStoredBlock(TokenOutputStream * outputStream);
+
+		/**
+		 * <summary> Reads long-range reference behind its marker (distance and length) and copies it from the history.</summary>
+		 *
+		 * <param name="reader">		The reader of the matches.</param>
+		 * <param name="outputStream"> The output stream.</param>
+		 */
+
+		void DecodeLongRangeMatch(BitReader & reader, TokenOutputStream * outputStream);
+
+		/**
+		 * <summary> Reads header and sub-streams of block of split layout into splitFlags, splitLiterals and splitMatches.</summary>
+		 *
+		 * <returns> Number of items of the block.</returns>
+		 */
+
+		int ReadSplitBlock();
+
+		/**
+		 * <summary> Decodes block of split layout - flags are read 64 at a time, literals and matches from their own
+		 *  sub-streams.</summary>
+		 *
+		 * <param name="outputStream"> The output stream.</param>
+		 *
+		 * <returns> True if the block holds the end of data.</returns>
+		 */
+
+		bool DecodeSplitBlock(TokenOutputStream * outputStream);
+
+		/**
+		 * <summary> Puts the last window of the reference into the tree without any output.</summary>
+		 */
+
+		void AppendReference();
+
+		/**
+		 * <summary> Puts the last window of the reference into the sliding window (and the whole reference to the history) while
+		 *  decoding.</summary>
+		 */
+
+		void AppendDecodedReference();
+
+		/**
+		 * <summary> Writes out the pending match and the stored block. Its symbols are not inserted into the tree, unless the
+		 *  block is windowed.</summary>
+		 *
+		 * <param name="symbols">  The block symbols.</param>
+		 * <param name="length">   Number of symbols.</param>
+		 * <param name="windowed"> Whether the symbols went through the tree already (they are in checksum too).</param>
+		 */
+
+		void WriteStoredBlock(const T * symbols, int length, bool windowed = false);
+
+		/**
+		 * <summary> Reads the next chunk of symbols and writes it as stored block.</summary>
+		 *
+		 * <param name="inputStream"> The input stream.</param>
+		 *
+		 * <returns> False if there are no more symbols.</returns>
+		 */
+
+		bool WriteStoredChunk(TokenInputStream * inputStream);
+
+		/**
+		 * <summary> Checks whether the last symbol ended a chunk - it has RawChunkSize symbols (as raw symbols are read from
+		 *  the input file) or it ends with independent block.</summary>
+		 *
+		 * <returns> True if the chunk ended.</returns>
+		 */
+
+		bool ChunkEnds();
+
+		/**
+		 * <summary> Marks the output in front of the next chunk, so that it can be taken back.</summary>
+		 */
+
+		void StartChunk();
+
+		/**
+		 * <summary> Ends the current chunk - its output is replaced by windowed stored block if it is bigger than the symbols.
+		 *  The chunk covered by long-range match at any of its ends stays as it is.</summary>
+		 *
+		 * <param name="inputStream"> The input stream.</param>
+		 */
+
+		void EndChunk(TokenInputStream * inputStream);
+
+		/**
+		 * <summary> Ends the current independent block (if any) and starts the next one with empty window.</summary>
+		 *
+		 * <param name="inputStream"> The input stream - to get position of the block in the input.</param>
+		 */
+
+		void StartBlock(TokenInputStream * inputStream);
+
+		/**
+		 * <summary> Drops the whole tree and creates empty one.</summary>
+		 */
+
+		void RestartWindow();
+
 		/**
 		 * <summary> Changes match position to new offset.</summary>
 		 *
@@ -227,10 +628,20 @@ class SuffixTree : public SuffixTreeAux
 		void ChangeMatchPositionToNew(VertexBase * child, VertexBase * parent);
 
 		/**
-		 * <summary> Updates the offsets.</summary>
+		 * <summary> Renumbers vertices in DFS order and relocates pointers that are held outside of the tree.</summary>
+		 */
+
+		void CompactTree();
+
+		/**
+		 * <summary> Updates the offsets of vertices on the way from given vertex towards the root. Every vertex passes the offset
+		 *  to its parent only every second time (it holds a credit in between), so the amortized cost is constant per new leaf.</summary>
+		 *
+		 * <param name="vertex"> The vertex, that got new leaf (or credit) into its subtree.</param>
+		 * <param name="offset"> The fresh offset.</param>
 		 */
 
-		void UpdateOffsets();
+		void UpdateOffsets(VertexBase * vertex, int offset);
 		
 		/**
 		* <summary> Searches for the end of edge, that starts with given symbol.</summary>
@@ -245,105 +656,319 @@ class SuffixTree : public SuffixTreeAux
 };
 
 //Definition----------------------------------------------------------------------------------------------------------------------------------------------------------
-template<typename T>
-SuffixTree<T>::SuffixTree(int windowSize, short slidingWindowSizeBits, short matchLengthSizeBits)
+template <typename T, int WindowBits>
+SuffixTree<T, WindowBits>::SuffixTree(int windowSize, short slidingWindowSizeBits, short matchLengthSizeBits)
 {
 	this->windowSize = windowSize;
-	this->buffer = new Buffer<T>(slidingWindowSizeBits);
-	this->matchBytesCount = ceil((double)(slidingWindowSizeBits + matchLengthSizeBits) / 8);
+	this->buffer = new Buffer<T, WindowBits>(slidingWindowSizeBits);
+	//index points into the buffer, which is twice the window size
+	this->matchBits = slidingWindowSizeBits + 1 + matchLengthSizeBits;
+	this->matchBytesCount = (matchBits + 7) / 8;
+	this->matchLengthBits = matchLengthSizeBits;
+
+	if (WindowBits > 0 && (slidingWindowSizeBits != WindowBits || matchLengthSizeBits != FixedMatchLengthBits))
+	{
+		fprintf(stderr, "FATAL:\tSuffix tree specialized for window of 2^%d symbols can't be used with these parameters\n", WindowBits);
+		exit(1);
+	}
 	this->matchAfterLongestSufixRemoval = false;
+	this->longRangeMatcher = NULL;
+	this->outputSuppressed = false;
+	this->keepHistory = false;
+	this->rawSymbols = NULL;
+	this->storedBlocks = false;
+	this->storedSymbols = NULL;
+	this->chunkSymbols = NULL;
+	this->chunkLength = 0;
+	this->showStrategies = false;
+	this->blockSymbols = 0;
+	this->nextBlockStart = 0;
+	this->blocksToDecode = 1;
+	this->sequences = false;
+	this->splitStreams = false;
+	this->checksums = false;
+	this->entropyCoding = false;
+	this->writeOutput = true;
 }
 
-template <typename T>
-SuffixTree<T>::~SuffixTree()
+template <typename T, int WindowBits>
+SuffixTree<T, WindowBits>::~SuffixTree()
 {
 	delete (buffer);
 }
 
-template<typename T>
-void SuffixTree<T>::InitForCompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile)
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::InitForCompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile, bool compactTree, bool longRange, bool repeatOffsets, bool sequences, bool splitStreams)
 {
+	this->compactTree = compactTree;
 	this->inStream.Open(inFile, true, binaryFile);
 	this->outStream.Open(outFile, true);
-	this->outputBytesHelper = new OutputBytesHelper<T>(outFile, matchBytesCount, &outStream);
+	this->encoder = Encoder(matchLengthSizeBits, matchBits, repeatOffsets);
+	this->outputBytesHelper = new OutputBytesHelper<T>(outFile, encoder.GetMatchBits(), &outStream, sequences, splitStreams);
 
-	this->encoder = Encoder(matchLengthSizeBits, matchBytesCount);
 	this->shortMatch = new T[matchBytesCount];
-	this->matchHelper = MatchHelper<T>(matchLengthSizeBits, shortMatch, matchBytesCount);
-	this->matchBytes = new uchar[matchBytesCount];
+	this->matchHelper = MatchHelper<T>(Encoder::MaxMatchLength(matchLengthSizeBits), shortMatch, matchBytesCount);
+
+	if (longRange)
+	{
+		this->longRangeMatcher = new LongRangeMatcher<T>(windowSize);
+		this->longRangeBytes = new uchar[LongRangeMatcher<T>::ExtraBytesCount];
+	}
 
 	CreateEmptyGraph();
 }
 
-template <typename T>
-void SuffixTree<T>::InitForDecompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile)
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::InitForDecompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile, bool longRange, bool repeatOffsets, bool sequences, bool splitStreams)
 {
+	this->keepHistory = longRange;
+	this->sequences = sequences;
+	this->splitStreams = splitStreams;
+
+	//nothing of the previously decoded part stays
+	buffer->Reset();
+	history.clear();
+	reference.clear();
+	decodedChecksums.clear();
+	contentChecksum.Reset();
+
 	this->inStream.Open(inFile, false);
-	this->outStream.Open(outFile, false, binaryFile);
+	this->writeOutput = outFile != NULL;
+	if (writeOutput)
+	{
+		this->outStream.Open(outFile, false, binaryFile);
+	}
 
-	decoder = Decoder(matchLengthSizeBits, matchBytesCount);
-	this->matchBytes = new uchar[matchBytesCount];
+	decoder = Decoder(matchLengthSizeBits, matchBits, repeatOffsets);
 }
 
-template <typename T>
-void SuffixTree<T>::FinishCompression()
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::FinishCompression()
 {
-	root->DeleteChildren();
-
-	delete[] leaves;
-	delete[] matchBytes;
+	HugePageAllocator::DeleteArray(leaves, windowSize);
 	delete[] shortMatch;
 
-	delete(root);
+	delete(vertexPool);
 	delete(bot);
+
+	if (longRangeMatcher != NULL)
+	{
+		delete[] longRangeBytes;
+		delete (longRangeMatcher);
+	}
+
+	delete[] rawSymbols;
+	delete[] storedSymbols;
+	delete[] chunkSymbols;
 }
 
-template <typename T>
-void SuffixTree<T>::FinishDecompression()
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::FinishDecompression()
 {
-	delete[] matchBytes;
 }
 
-template <typename T>
-void SuffixTree<T>::Compress(long int inputFileSize, bool showProgress, TokenInputStream * inputStream)
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::LoadReference(const char * referenceFile, const vector<int> * referenceTokens)
 {
-	double donePart, currentlyDonePart;
-	donePart = 0;
-	short dashesCount = 0;
-	cout.precision(2);
-	
-	T tokenId;
-	while (!inputStream->FileEnd() && (tokenId = inputStream->ReadToken()) != -1)
-	{
-		//check status every 64th run
-		if (showProgress && (symbolsProcessed & 0x3f) == 0)
-		{
-			double currentlyDonePart = (double)symbolsProcessed / inputFileSize;
-			if (currentlyDonePart - donePart > 0.04)
-			{
-				donePart = currentlyDonePart;
-				dashesCount = donePart / 0.04;
-				cout << "\r\t";
-				for (short i = 0; i < dashesCount; i++)
-				{
-					cout << "-";
-				}
-				cout << fixed << " " << donePart * 100 << " %";
-			}
-		}
+	Reference<T>::Load(referenceFile, referenceTokens, reference);
+}
 
-		AppendSymbol(tokenId);
-		symbolsProcessed++;
-	}
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::SkipInput(long long bytes)
+{
+	inStream.Seek(bytes);
+}
 
-	if (showProgress)
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::WriteFrameHeader(FrameHeader header)
+{
+	uchar bytes[FrameHeader::Size];
+	header.SymbolWidth = sizeof(T);
+	header.BlockSize = blockSymbols;
+	header.Encode(bytes);
+
+	for (short i = 0; i < FrameHeader::Size; i++)
 	{
-		cout << "\r\t" << "-";
-		for (short i = 1; i < dashesCount; i++)
-		{
-			cout << "-";
-		}
-		cout << " " << 100.0 << " %";
+		outStream.WriteByte(bytes[i]);
+	}
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::SetIndependentBlocks(int blockSymbols)
+{
+	this->blockSymbols = blockSymbols;
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::SetBlocksToDecode(int count)
+{
+	this->blocksToDecode = count;
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::SetChecksums(bool checksums)
+{
+	this->checksums = checksums;
+	blockIndex.SetChecksums(checksums);
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::SetEntropyCoding(bool entropyCoding)
+{
+	this->entropyCoding = entropyCoding;
+}
+
+template <typename T, int WindowBits>
+const vector<unsigned int>& SuffixTree<T, WindowBits>::GetDecodedChecksums() const
+{
+	return decodedChecksums;
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::Compress(long long inputFileSize, bool showProgress, TokenInputStream * inputStream, double timeBudget)
+{
+	double donePart, currentlyDonePart;
+	donePart = 0;
+	short dashesCount = 0;
+	cout.precision(2);
+
+	if (longRangeMatcher != NULL)
+	{
+		longRangeMatcher->AddReference(reference);
+	}
+
+	if (longRangeMatcher != NULL && inputStream != NULL)
+	{
+		longRangeMatcher->Load(inputStream);
+	}
+	else if (longRangeMatcher != NULL)
+	{
+		longRangeMatcher->Load(&inStream);
+	}
+	else if (inputStream == NULL)
+	{
+		rawSymbols = new T[RawChunkSize];
+		rawSymbolsCount = rawSymbolsPosition = 0;
+		rawSymbolsRead = 0;
+	}
+
+	storedBlocks = StoredBlock<T>::IsAvailable(WindowSize());
+	if (storedBlocks)
+	{
+		chunkSymbols = new T[RawChunkSize];
+	}
+
+	AppendReference();
+
+	TimeBudget * budget = (timeBudget > 0) ? new TimeBudget(timeBudget, inputFileSize) : NULL;
+	CompressionStrategyEnum strategy = LevelStrategy;
+	showStrategies = storedBlocks || budget != NULL;
+	
+	//input that is not split has one block for its checksums
+	if (checksums && blockSymbols == 0)
+	{
+		StartBlock(inputStream);
+	}
+
+	T tokenId;
+	while (true)
+	{
+		if (blockSymbols > 0 && symbolsProcessed >= nextBlockStart)
+		{
+			StartBlock(inputStream);
+		}
+
+		//the long-range match in progress is finished by the tree
+		if (strategy == StoredStrategy && !outputSuppressed)
+		{
+			if (chunkLength > 0)
+			{
+				EndChunk(inputStream);
+			}
+
+			if (!WriteStoredChunk(inputStream))
+				break;
+			continue;
+		}
+
+		//the chunk starts behind the end of independent block, which can't be taken back
+		if (storedBlocks && chunkLength == 0)
+		{
+			StartChunk();
+		}
+
+		if (!ReadToken(inputStream, tokenId))
+			break;
+
+		//check status every 64th run
+		if (showProgress && (symbolsProcessed & 0x3f) == 0)
+		{
+			double currentlyDonePart = (double)symbolsProcessed / inputFileSize;
+			if (currentlyDonePart - donePart > 0.04)
+			{
+				donePart = currentlyDonePart;
+				dashesCount = donePart / 0.04;
+				cout << "\r\t";
+				for (short i = 0; i < dashesCount; i++)
+				{
+					cout << "-";
+				}
+				cout << fixed << " " << donePart * 100 << " %";
+			}
+		}
+
+		if (longRangeMatcher != NULL && longRangeMatcher->NextMatchPosition() == symbolsProcessed)
+		{
+			BeginLongRangeMatch();
+		}
+
+		AppendSymbol(tokenId);
+		symbolsProcessed++;
+
+		if (storedBlocks)
+		{
+			chunkSymbols[chunkLength] = tokenId;
+		}
+		chunkLength++;
+
+		if (checksums)
+		{
+			contentChecksum.UpdateSymbol(tokenId);
+		}
+
+		if (outputSuppressed && symbolsProcessed == longRangeMatchEnd)
+		{
+			EndLongRangeMatch();
+		}
+
+		//the tree can't change its window or matcher, so the only faster way is to store the rest
+		if (ChunkEnds())
+		{
+			EndChunk(inputStream);
+
+			if (budget != NULL && StoredBlock<T>::IsAvailable(WindowSize()) && budget->IsAtRisk(symbolsProcessed))
+			{
+				strategy = StoredStrategy;
+				cout << endl << "\tTime budget at risk after " << fixed << setprecision(2) << budget->GetElapsedSeconds() << " s - the rest from symbol " << symbolsProcessed << " is stored" << endl;
+			}
+		}
+	}
+
+	if (chunkLength > 0)
+	{
+		EndChunk(inputStream);
+	}
+
+	delete (budget);
+
+	if (showProgress)
+	{
+		cout << "\r\t" << "-";
+		for (short i = 1; i < dashesCount; i++)
+		{
+			cout << "-";
+		}
+		cout << " " << 100.0 << " %";
 	}
 
 	//if there exist a match at the very end of string
@@ -352,24 +977,36 @@ void SuffixTree<T>::Compress(long int inputFileSize, bool showProgress, TokenInp
 		WriteMatch();
 	}
 
-	encoder.EncodeMatch(matchHelper.GetMatchWithZeroLength(outputBytesHelper->GetRemainingFlagsCount()), matchBytes);
-	outputBytesHelper->FinishWork(matchBytes);
+	outputBytesHelper->FinishWork(EncodeMatch(matchHelper.GetMatchWithZeroLength(outputBytesHelper->GetRemainingFlagsCount())));
+
+	if (blockIndex.GetCount() > 0)
+	{
+		if (checksums)
+		{
+			blockIndex.SetLastChecksums(outStream.TakeChecksum(), contentChecksum.GetValue());
+		}
+
+		vector<uchar> indexBytes;
+		blockIndex.Encode(indexBytes);
+		for (uchar indexByte : indexBytes)
+		{
+			outStream.WriteByte(indexByte);
+		}
+	}
 
 	inStream.Close();
 	outStream.Close();
 }
 
-template <typename T>
-void SuffixTree<T>::Decompress(long int inputFileSize, bool showProgress, TokenOutputStream* outputStream)
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::Decompress(long long inputFileSize, bool showProgress, TokenOutputStream* outputStream)
 {
 	uchar flagsByte;
-	T decodedSymbol;
-	uchar byte;
-	T symbolForOutput;
 	bool finish = false;
 	short bitsInByteCount = 8;
+	int blocksLeft = blocksToDecode;
 
-	flagsByte = inStream.ReadByte();
+	AppendDecodedReference();
 
 	chrono::time_point<chrono::steady_clock> startTime = chrono::high_resolution_clock::now();
 	chrono::time_point<chrono::steady_clock> currentTime;
@@ -379,77 +1016,105 @@ void SuffixTree<T>::Decompress(long int inputFileSize, bool showProgress, TokenO
 	//repeat until EOF
 	while (true)
 	{
-		for (short i = 0; i < bitsInByteCount; i++)
+		if (showProgress)
 		{
-			if (showProgress)
+			currentTime = chrono::high_resolution_clock::now();
+			elapsedTime = chrono::duration_cast<chrono::microseconds>(currentTime - startTime).count() / 1000;
+			if (elapsedTime > 500)
 			{
-				currentTime = chrono::high_resolution_clock::now();
-				elapsedTime = chrono::duration_cast<chrono::microseconds>(currentTime - startTime).count() / 1000;
-				if (elapsedTime > 500)
+				totalElapsedTime += elapsedTime;
+				startTime = currentTime;
+				double donePart = (double)inStream.GetBytesRead() / inputFileSize;
+				int dashesCount = donePart / 0.05;
+				cout << "\r\t";
+				for (short i = 0; i < dashesCount; i++)
 				{
-					totalElapsedTime += elapsedTime;
-					startTime = currentTime;
-					double donePart = (double)inStream.GetBytesRead() / inputFileSize;
-					int dashesCount = donePart / 0.05;
-					cout << "\r\t";
-					for (short i = 0; i < dashesCount; i++)
-					{
-						cout << "-";
-					}
-					cout << fixed << setprecision(2) << " " << donePart * 100 << " % [" << setprecision(3) << (double)totalElapsedTime / 1000 << " s]";
+					cout << "-";
 				}
+				cout << fixed << setprecision(2) << " " << donePart * 100 << " % [" << setprecision(3) << (double)totalElapsedTime / 1000 << " s]";
 			}
+		}
 
-			DecodeResultEnum result = decoder.DecodeBit(flagsByte, i);
+		inStream.FillBits();
 
-			if (result == DecodeResultEnum::LiteralResult)
+		//one branch per sequence - the literals in front of the match go in one run
+		if (sequences)
+		{
+			if (DecodeLiteralRun(outputStream) < OutputBytesHelper<T>::MaxLiteralRun)
 			{
-				decodedSymbol = 0;
-				decodedSymbol = inStream.ReadSymbolBin();
-
-				buffer->AppendSymbolToSlidingWindow(decodedSymbol);
-
-				if (buffer->SlidingWindowIsEmptyWhileDecoding())
-				{
-					symbolForOutput = buffer->GetLastSymbol();
-					outputStream->WriteToken(symbolForOutput);
-				}
+				Match match = ReadMatch(inStream.GetBitReader());
+
+				if (match.MatchLength > 0)
+					CopyMatch(match, outputStream);
+				else if (match.MatchIndex == StoredBlock<T>::MarkerIndex)
+					DecodeStoredBlock(outputStream);
+				else if (match.MatchIndex == LongRangeMatcher<T>::MarkerIndex)
+					DecodeLongRangeMatch(inStream.GetBitReader(), outputStream);
+				else
+					finish = true;
 			}
-			else
+		}
+		else if (splitStreams)
+		{
+			finish = DecodeSplitBlock(outputStream);
+		}
+		else
+		{
+			flagsByte = (uchar)inStream.ReadBits(8);
+
+			for (short i = 0; i < bitsInByteCount; i++)
 			{
-				for (short j = 0; j < matchBytesCount; j++)
+				DecodeResultEnum result = decoder.DecodeBit(flagsByte, i);
+
+				if (result == DecodeResultEnum::LiteralResult)
 				{
-					matchBytes[j] = inStream.ReadByte();
+					AppendDecodedSymbol((T)inStream.ReadBits(8 * sizeof(T)), outputStream);
+					continue;
 				}
 
-				Match match = decoder.DecodeMatch(matchBytes);
-
-				//signal, that very last part is processed
-				if (match.MatchLength == 0)
+				Match match = ReadMatch(inStream.GetBitReader());
+				if (match.MatchLength > 0)
 				{
-					finish = true;
-					bitsInByteCount = match.MatchIndex + 1;
+					CopyMatch(match, outputStream);
 					continue;
 				}
 
-				buffer->SetMatchIndex(match.MatchIndex);
-				for (int j = 0; j < match.MatchLength; j++)
+				//stored block - the group of flags ends
+				if (match.MatchIndex == StoredBlock<T>::MarkerIndex)
 				{
-					buffer->AppendMatchSymbol();
+					DecodeStoredBlock(outputStream);
+					break;
+				}
 
-					if (buffer->SlidingWindowIsEmptyWhileDecoding())
-					{
-						symbolForOutput = buffer->GetLastSymbol();
-						outputStream->WriteToken(symbolForOutput);
-					}
+				if (match.MatchIndex == LongRangeMatcher<T>::MarkerIndex)
+				{
+					DecodeLongRangeMatch(inStream.GetBitReader(), outputStream);
+					continue;
 				}
+
+				//signal, that very last part is processed
+				finish = true;
+				bitsInByteCount = match.MatchIndex + 1;
 			}
 		}
 
-		if (finish)
-			break;
+		if (finish && checksums)
+		{
+			decodedChecksums.push_back(contentChecksum.GetValue());
+			contentChecksum.Reset();
+		}
 
-		flagsByte = inStream.ReadByte();
+		//the next independent block starts with empty window at byte border
+		if (finish && --blocksLeft > 0)
+		{
+			buffer->Reset();
+			decoder.ResetRepeatOffsets();
+			inStream.AlignToByte();
+			finish = false;
+			bitsInByteCount = 8;
+		}
+		else if (finish)
+			break;
 	}
 
 	if (showProgress)
@@ -463,21 +1128,15 @@ void SuffixTree<T>::Decompress(long int inputFileSize, bool showProgress, TokenO
 		cout << fixed << setprecision(2) << " " << 100.0 << " % [" << (double)totalElapsedTime / 1000 << " s]";
 	}
 
-	if (!buffer->SlidingWindowIsEmptyWhileDecoding())
+	inStream.Close();
+	if (writeOutput)
 	{
-		do
-		{
-			decodedSymbol = buffer->GetLastSymbol();
-			outputStream->WriteToken(decodedSymbol);
-		} while (!buffer->SlidingWindowIsEmptyWhileDecoding());
+		outStream.Close();
 	}
-
-	inStream.Close();
-	outStream.Close();
 }
 
-template <typename T>
-void SuffixTree<T>::WriteTree()
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::WriteTree()
 {
 	Vertex * vertex = this->root;
 
@@ -489,47 +1148,69 @@ void SuffixTree<T>::WriteTree()
 	cout << "\n----------------------" << endl;
 }
 
-template <typename T>
-void SuffixTree<T>::WriteCompressionStatistics()
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::WriteCompressionStatistics()
 {
 	cout << "======================================================================================" << endl;
 	cout << "Bytes written / read: " << outStream.GetBytesWritten() << " / " << inStream.GetBytesRead() << endl;
 	cout << "Compression ratio: " << (double)outStream.GetBytesWritten() / inStream.GetBytesRead() * 100 << " (" << (double)(outStream.GetBytesWritten() * 8) / inStream.GetBytesRead() << " bpB)" << endl;
+	if (showStrategies)
+	{
+		cout << "Chunks of " << RawChunkSize << " symbols - suffix tree: " << chunkStrategies.GetCount(LevelStrategy) << ", stored: " << chunkStrategies.GetCount(StoredStrategy) << endl;
+		chunkStrategies.Write("Chunks", "suffix tree");
+	}
+	WriteHugePagesStatistics();
 	cout << "======================================================================================" << endl;
 }
 
-template <typename T>
-void SuffixTree<T>::WriteDecompressionStatistics()
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::WriteDecompressionStatistics()
 {
 	cout << "======================================================================================" << endl;
 	cout << "Bytes read: " << inStream.GetBytesRead() << endl;
 	cout << "Bytes written: " << outStream.GetBytesWritten() << endl;
+	WriteHugePagesStatistics();
 	cout << "======================================================================================" << endl;
 }
 
-template <typename T>
-void SuffixTree<T>::AppendSymbol(T symbol)
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::WriteHugePagesStatistics()
+{
+	cout << "Huge pages: ";
+	if (HugePageAllocator::ExplicitHugePagesObtained())
+		cout << "obtained";
+	else if (HugePageAllocator::GetBytesOnHugePages() > 0)
+		cout << "requested (transparent)";
+	else
+		cout << "not obtained";
+	cout << " for " << HugePageAllocator::GetBytesOnHugePages() / 1000 << " of " << HugePageAllocator::GetBytesAllocated() / 1000 << " Kbytes" << endl;
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::AppendSymbol(T symbol)
 {
 	MoveActivePointDown(symbol);
 	MoveForward(symbol);
 	//WriteTree();
 
-	//if buffer is full, remove oldest symbol - free position for new symbol, occasionally update offsets
+	//if buffer is full, remove oldest symbol - free position for new symbol, occasionally restore locality of vertices
 	if (this->buffer->SlidingWindowIsFull())
 	{
 		RemoveOldestSymbol();
 
-		if (this->buffer->FrontIsOnEdge())
+		if (this->compactTree && this->buffer->FrontIsOnEdge())
 		{
-			UpdateOffsets();
+			CompactTree();
 		}
 	}
 }
 
-template <typename T>
-void SuffixTree<T>::CreateEmptyGraph()
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::CreateEmptyGraph()
 {
-	this->leaves = new Leaf[this->windowSize];
+	this->leaves = HugePageAllocator::NewArray<Leaf>(this->windowSize);
+	//every inner vertex has at least two children, so there is less of them than leaves (+ root)
+	this->vertexPool = new VertexPool<T>(this->windowSize + 1);
 	this->newLeafIndex = 0;
 	this->oldestLeafIndex = 0;
 	this->lastVertexWithoutSuffixLinkEnd = NULL;
@@ -539,28 +1220,28 @@ void SuffixTree<T>::CreateEmptyGraph()
 	MoveActivePointToRoot();
 }
 
-template <typename T>
-void SuffixTree<T>::CreateBotRoot()
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::CreateBotRoot()
 {
-	this->root = new Vertex<T>(0);
+	this->root = this->vertexPool->NewVertex(0);
 	this->bot = new VertexChild();
 }
 
-template <typename T>
-int SuffixTree<T>::GetOldestLeafIndex()
+template <typename T, int WindowBits>
+int SuffixTree<T, WindowBits>::GetOldestLeafIndex()
 {
 	return this->oldestLeafIndex;
 }
 
-template <typename T>
-void SuffixTree<T>::MoveActivePointToRoot()
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::MoveActivePointToRoot()
 {
 	this->activePoint.start = this->root;
 	this->activePoint.end = NULL;
 }
 
-template <typename T>
-void SuffixTree<T>::MoveActivePointDown(T symbol)
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::MoveActivePointDown(T symbol)
 {
 	//Repeat until successful move down
 	while (!MoveActivePointDownIfPossible(symbol))
@@ -570,6 +1251,7 @@ void SuffixTree<T>::MoveActivePointDown(T symbol)
 			//In node
 			Leaf * newLeaf = this->GetNewLeaf(activePoint.start);
 			static_cast<Vertex<T>*>(activePoint.start)->AddChild(newLeaf);
+			UpdateOffsets(activePoint.start, newLeaf->offsetInBuffer);
 
 			MoveActivePointSideways();
 		}
@@ -577,7 +1259,7 @@ void SuffixTree<T>::MoveActivePointDown(T symbol)
 		{
 			//On edge
 			//Create new edge between AP start and AP end
-			Vertex<T> * newNode = new Vertex<T>(this->activePoint.end->offsetInBuffer);
+			Vertex<T> * newNode = this->vertexPool->NewVertex(this->activePoint.end->offsetInBuffer);
 			Vertex<T> * apStart = static_cast<Vertex<T>*>(this->activePoint.start);
 			newNode->parent = apStart;
 			newNode->depthInTree = apStart->depthInTree + this->activePoint.length;
@@ -590,6 +1272,7 @@ void SuffixTree<T>::MoveActivePointDown(T symbol)
 
 			Leaf * newLeaf = this->GetNewLeaf(newNode);
 			newNode->AddChild(newLeaf);
+			UpdateOffsets(newNode, newLeaf->offsetInBuffer);
 
 			if (lastVertexWithoutSuffixLinkEnd != NULL)
 			{
@@ -613,22 +1296,25 @@ void SuffixTree<T>::MoveActivePointDown(T symbol)
 	}
 }
 
-template <typename T>
-bool SuffixTree<T>::MoveActivePointDownIfPossible(T symbol)
+template <typename T, int WindowBits>
+bool SuffixTree<T, WindowBits>::MoveActivePointDownIfPossible(T symbol)
 {
 	//In BOT - only move to root
 	if (this->activePoint.start == this->bot)
 	{
 		this->activePoint.start = this->root;
 		this->activePoint.end = NULL;
-		++this->activePoint.offsetOnBuffer %= 2 * windowSize;
+		++this->activePoint.offsetOnBuffer &= BufferSize() - 1;
 
 		if (activePoint.length > 0)
 		{
 			this->activePoint.length--;
 		}
 
-		outputBytesHelper->AppendSymbol(symbol);
+		if (!outputSuppressed)
+		{
+			outputBytesHelper->AppendSymbol(symbol);
+		}
 
 		return true;
 	}
@@ -659,8 +1345,8 @@ bool SuffixTree<T>::MoveActivePointDownIfPossible(T symbol)
 				positionInBuffer = position;
 				position = child->offsetInBuffer + apStart->depthInTree - buffer->GetSlidingWindowFront();
 
-				if (position < 0) position += 2 * windowSize;
-				if (positionInBuffer >= 2 * windowSize) positionInBuffer -= 2 * windowSize;
+				if (position < 0) position += BufferSize();
+				if (positionInBuffer >= BufferSize()) positionInBuffer -= BufferSize();
 				//when branching, match position may change (all occurences of right branching factor are elsewhere in string -> it is needed to update it
 				if (matchHelper.GetMatchLength() > 0)
 				{
@@ -698,8 +1384,23 @@ bool SuffixTree<T>::MoveActivePointDownIfPossible(T symbol)
 		{
 			int position = apStart->depthInTree + activePoint.end->offsetInBuffer + activePoint.length - buffer->GetSlidingWindowFront();
 			int positionInBuffer = apStart->depthInTree + activePoint.end->offsetInBuffer + activePoint.length;
-			if (position < 0) position += 2 * windowSize;
-			if (positionInBuffer >= 2 * windowSize) positionInBuffer -= 2 * windowSize;
+			if (position < 0) position += BufferSize();
+			if (positionInBuffer >= BufferSize()) positionInBuffer -= BufferSize();
+
+			//offset of edge end may have been refreshed during the match - continue from the new occurrence (valid only if match is not longer than AP)
+			if (matchHelper.GetMatchLength() > 0 && ((matchHelper.MatchBufPosition + matchHelper.GetMatchLength()) & (BufferSize() - 1)) != positionInBuffer)
+			{
+				if (matchHelper.GetMatchLength() > apStart->depthInTree + activePoint.length)
+				{
+					WriteMatch();
+					matchAfterLongestSufixRemoval = false;
+				}
+				else
+				{
+					matchHelper.MatchPosition = position;
+					matchHelper.MatchBufPosition = positionInBuffer - matchHelper.GetMatchLength();
+				}
+			}
 
 			if (!matchHelper.MoveMatchForward(position, positionInBuffer, symbol))
 			{
@@ -720,24 +1421,24 @@ bool SuffixTree<T>::MoveActivePointDownIfPossible(T symbol)
 	return false;
 }
 
-template <typename T>
-Leaf * SuffixTree<T>::GetNewLeaf(VertexBase * parent)
+template <typename T, int WindowBits>
+Leaf * SuffixTree<T, WindowBits>::GetNewLeaf(VertexBase * parent)
 {
 	Leaf * newLeaf = &(this->leaves[newLeafIndex]);
-	++newLeafIndex %= this->windowSize;
+	++newLeafIndex &= WindowSize() - 1;
 	Vertex<T> * apStart = static_cast<Vertex<T>*>(this->activePoint.start);
 	newLeaf->parent = parent;
 	newLeaf->nextSibling = NULL;
 
 	int offset = this->buffer->GetSlidingWindowFront() - (apStart->depthInTree + this->activePoint.length);
-	if (offset < 0)					offset += 2 * windowSize;
+	if (offset < 0)					offset += BufferSize();
 
 	newLeaf->offsetInBuffer = offset;
 	return newLeaf;
 }
 
-template <typename T>
-void SuffixTree<T>::MoveActivePointSideways()
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::MoveActivePointSideways()
 {
 	Vertex<T>* apStart = static_cast<Vertex<T>*>(this->activePoint.start);
 	this->activePoint.start = apStart->GetSuffixLink();
@@ -745,16 +1446,16 @@ void SuffixTree<T>::MoveActivePointSideways()
 	CanonizeAP();
 }
 
-template <typename T>
-void SuffixTree<T>::MoveForward(T symbol)
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::MoveForward(T symbol)
 {
 	this->buffer->AppendSymbolToSlidingWindow(symbol);
 
 	CanonizeAP();
 }
 
-template <typename T>
-void SuffixTree<T>::CanonizeAP()
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::CanonizeAP()
 {
 	if (activePoint.length > 0)
 	{
@@ -762,13 +1463,13 @@ void SuffixTree<T>::CanonizeAP()
 		this->activePoint.end = (apStart) ? apStart->FindOutEdgeEnd(this->buffer->GetSymbolFromBuffer(this->activePoint.offsetOnBuffer), this->buffer) : this->root;
 		Vertex<T>* apEnd = dynamic_cast<Vertex<T>*>(this->activePoint.end);
 
-		int endDepth = (apEnd) ? apEnd->depthInTree : this->windowSize;
-		int edgeLength = (apStart) ? (apEnd) ? endDepth - apStart->depthInTree : this->windowSize : 1;
+		int endDepth = (apEnd) ? apEnd->depthInTree : WindowSize();
+		int edgeLength = (apStart) ? (apEnd) ? endDepth - apStart->depthInTree : WindowSize() : 1;
 
 		while (this->activePoint.length >= edgeLength)
 		{
 			this->activePoint.start = static_cast<VertexChild*>(this->activePoint.end);
-			this->activePoint.offsetOnBuffer += edgeLength; this->activePoint.offsetOnBuffer %= 2 * windowSize;
+			this->activePoint.offsetOnBuffer += edgeLength; this->activePoint.offsetOnBuffer &= BufferSize() - 1;
 			this->activePoint.length -= edgeLength;
 
 			if (this->activePoint.length == 0)
@@ -778,22 +1479,23 @@ void SuffixTree<T>::CanonizeAP()
 			int symbol = this->buffer->GetSymbolFromBuffer(activePoint.offsetOnBuffer);
 			activePoint.end = apStart->FindOutEdgeEnd(this->buffer->GetSymbolFromBuffer(this->activePoint.offsetOnBuffer), this->buffer);
 			apEnd = dynamic_cast<Vertex<T>*>(activePoint.end);
-			edgeLength = (apEnd) ? apEnd->depthInTree - apStart->depthInTree : this->windowSize;
+			edgeLength = (apEnd) ? apEnd->depthInTree - apStart->depthInTree : WindowSize();
 		}
 	}
 }
 
-template <typename T>
-void SuffixTree<T>::RemoveOldestSymbol()
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::RemoveOldestSymbol()
 {
 	Leaf * oldestLeaf = &(this->leaves[oldestLeafIndex++]);
-	oldestLeafIndex %= this->windowSize;
+	oldestLeafIndex &= WindowSize() - 1;
 	Vertex<T> * apStart = static_cast<Vertex<T>*>(this->activePoint.start);
 
 	if (this->activePoint.end == oldestLeaf)
 	{
 		Leaf * newLeaf = GetNewLeaf(apStart);
 		apStart->ReplaceChild(oldestLeaf, newLeaf);
+		UpdateOffsets(apStart, newLeaf->offsetInBuffer);
 
 		if (matchHelper.GetMatchLength() == 1 && this->activePoint.start == this->root)
 		{
@@ -841,7 +1543,7 @@ void SuffixTree<T>::RemoveOldestSymbol()
 
 					activePoint.start = parentOfParent;
 					activePoint.length += edgeLength;
-					activePoint.offsetOnBuffer = (activePoint.offsetOnBuffer - edgeLength >= 0) ? activePoint.offsetOnBuffer - edgeLength : activePoint.offsetOnBuffer - edgeLength + 2 * windowSize;
+					activePoint.offsetOnBuffer = (activePoint.offsetOnBuffer - edgeLength >= 0) ? activePoint.offsetOnBuffer - edgeLength : activePoint.offsetOnBuffer - edgeLength + BufferSize();
 				}
 				//if active point ends at parent - end must move to child
 				else if (parent == this->activePoint.end)
@@ -860,7 +1562,13 @@ void SuffixTree<T>::RemoveOldestSymbol()
 				parentOfParent->RemoveChild(parent);
 				child->parent = parentOfParent;
 
-				delete(parent);
+				//credit of removed vertex must not get lost - pass it to its parent
+				if (parent->credit)
+				{
+					UpdateOffsets(parentOfParent, buffer->IsOffsetNewer(child->offsetInBuffer, parent->offsetInBuffer) ? child->offsetInBuffer : parent->offsetInBuffer);
+				}
+
+				vertexPool->DeleteVertex(parent);
 
 				CanonizeAP();
 			}
@@ -870,16 +1578,29 @@ void SuffixTree<T>::RemoveOldestSymbol()
 	buffer->MoveBackForward();
 }
 
-template <typename T>
-void SuffixTree<T>::WriteMatch()
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::WriteMatch()
 {
+	int matchStart = matchHelper.MatchBufPosition - matchHelper.MatchPosition;
 	short matchSingleCharsCount = matchHelper.GetMatch(match);
 
+	if (outputSuppressed)
+		return;
+
 	if (matchSingleCharsCount == -1)
 	{
-		encoder.EncodeMatch(match, matchBytes);
-
-		outputBytesHelper->AppendMatch(matchBytes);
+		PreferRepeatOffset(matchStart);
+
+		//long match has the rest of its length in extension bytes
+		uchar extensionBytes[Encoder::MaxExtensionBytes];
+		short extensionBytesCount = Encoder::EncodeLengthExtension(match.MatchLength, MatchLengthBits(), extensionBytes);
+		short repeatSlot = encoder.UpdateRepeatOffsets(match.MatchIndex);
+		if (repeatSlot >= 0)
+			outputBytesHelper->AppendMatch(encoder.EncodeRepeatMatch(repeatSlot, match.MatchLength), encoder.GetRepeatMatchBits(), extensionBytes, extensionBytesCount);
+		else if (extensionBytesCount > 0)
+			outputBytesHelper->AppendMatch(EncodeMatch(match), extensionBytes, extensionBytesCount);
+		else
+			outputBytesHelper->AppendMatch(EncodeMatch(match));
 	}
 	else
 	{
@@ -890,50 +1611,643 @@ void SuffixTree<T>::WriteMatch()
 	}
 }
 
-template <typename T>
-void SuffixTree<T>::ChangeMatchPositionToNew(VertexBase * child, VertexBase * parent)
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::PreferRepeatOffset(int matchStart)
+{
+	//the most recent slot is filled first - the history is empty (or repeat codes are not used)
+	if (encoder.GetRepeatOffset(0) == 0)
+		return;
+
+	int mask = BufferSize() - 1;
+	match.MatchIndex &= mask;
+	matchStart &= mask;
+	for (short slot = 0; slot < RepeatOffsets::Count; slot++)
+	{
+		if (encoder.GetRepeatOffset(slot) == match.MatchIndex)
+			return;
+	}
+
+	//the whole match has to be in the window already
+	int front = buffer->GetSlidingWindowFront();
+	int windowLength = (front - buffer->GetSlidingWindowBack()) & mask;
+	int matchDistance = (front - matchStart) & mask;
+	if (match.MatchLength > matchDistance || matchDistance > windowLength)
+		return;
+
+	for (short slot = 0; slot < RepeatOffsets::Count; slot++)
+	{
+		//empty slot, or the candidate starts behind the back of window
+		int index = encoder.GetRepeatOffset(slot);
+		if (index == 0 || ((BufferSize() - index) & mask) > windowLength - matchDistance)
+			continue;
+
+		int length = 0;
+		while (length < match.MatchLength && buffer->GetSymbolFromBuffer(matchStart + index + length) == buffer->GetSymbolFromBuffer(matchStart + length))
+		{
+			length++;
+		}
+
+		if (length == match.MatchLength)
+		{
+			match.MatchIndex = index;
+			return;
+		}
+	}
+}
+
+template <typename T, int WindowBits>
+inline bool SuffixTree<T, WindowBits>::ReadToken(TokenInputStream * inputStream, T & token)
+{
+	if (longRangeMatcher != NULL)
+		return longRangeMatcher->ReadToken(token);
+
+	if (inputStream == NULL)
+	{
+		if (rawSymbolsPosition == rawSymbolsCount)
+		{
+			//chunk doesn't reach into the next independent block
+			int chunkSize = (blockSymbols > 0 && nextBlockStart - rawSymbolsRead < RawChunkSize) ? nextBlockStart - rawSymbolsRead : RawChunkSize;
+			rawSymbolsCount = inStream.ReadSymbols(rawSymbols, chunkSize);
+			rawSymbolsPosition = 0;
+			rawSymbolsRead += rawSymbolsCount;
+
+			if (rawSymbolsCount == 0)
+				return false;
+
+			//the chunk is compared with its symbols by the size of its literals after entropy coding
+			if (entropyCoding)
+			{
+				outputBytesHelper->SetLiteralBits(StoredBlock<T>::EntropyCodedLiteralBits(rawSymbols, rawSymbolsCount));
+			}
+		}
+
+		token = rawSymbols[rawSymbolsPosition++];
+		return true;
+	}
+
+	int tokenId;
+	if ((tokenId = inputStream->ReadToken()) == -1)
+		return false;
+
+	token = tokenId;
+	return true;
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::BeginLongRangeMatch()
+{
+	LongRangeMatch longRangeMatch = longRangeMatcher->TakeMatch();
+
+	if (matchHelper.GetMatchLength() > 0)
+	{
+		WriteMatch();
+	}
+	matchAfterLongestSufixRemoval = false;
+
+	LongRangeMatcher<T>::EncodeExtraBytes(longRangeMatch, longRangeBytes);
+	outputBytesHelper->AppendMatch(EncodeMatch(Match(LongRangeMatcher<T>::MarkerIndex, 0)), longRangeBytes, LongRangeMatcher<T>::ExtraBytesCount);
+
+	//symbols still go through the tree, so that the window stays the same as while decoding
+	outputSuppressed = true;
+	longRangeMatchEnd = longRangeMatch.Position + longRangeMatch.Length;
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::EndLongRangeMatch()
+{
+	if (matchHelper.GetMatchLength() > 0)
+	{
+		WriteMatch();
+	}
+	matchAfterLongestSufixRemoval = false;
+
+	outputSuppressed = false;
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::WriteStoredBlock(const T * symbols, int length, bool windowed)
+{
+	if (matchHelper.GetMatchLength() > 0)
+	{
+		WriteMatch();
+	}
+	matchAfterLongestSufixRemoval = false;
+
+	uchar lengthBytes[StoredBlock<T>::ExtraBytesCount];
+	StoredBlock<T>::EncodeLength(length, lengthBytes, windowed);
+	outputBytesHelper->AppendStoredBlock(EncodeMatch(Match(StoredBlock<T>::MarkerIndex, 0)), lengthBytes, StoredBlock<T>::ExtraBytesCount, symbols, length);
+
+	if (checksums && !windowed)
+	{
+		contentChecksum.UpdateSymbols(symbols, length);
+	}
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::AppendReference()
+{
+	if (reference.empty())
+		return;
+
+	//the same as symbols of long-range match - they go through the tree, but not to the output
+	outputSuppressed = true;
+	for (size_t i = Reference<T>::WindowStart(reference, WindowSize()); i < reference.size(); i++)
+	{
+		AppendSymbol(reference[i]);
+	}
+	EndLongRangeMatch();
+
+	vector<T>().swap(reference);
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::AppendDecodedReference()
+{
+	if (reference.empty())
+		return;
+
+	//long-range references may reach anywhere into the reference
+	if (keepHistory)
+	{
+		history = reference;
+	}
+
+	for (size_t i = Reference<T>::WindowStart(reference, WindowSize()); i < reference.size(); i++)
+	{
+		buffer->AppendSymbolToSlidingWindow(reference[i]);
+
+		if (buffer->SlidingWindowIsEmptyWhileDecoding())
+		{
+			buffer->MoveBackForward();
+		}
+	}
+
+	vector<T>().swap(reference);
+}
+
+template <typename T, int WindowBits>
+bool SuffixTree<T, WindowBits>::WriteStoredChunk(TokenInputStream * inputStream)
+{
+	if (storedSymbols == NULL)
+	{
+		storedSymbols = new T[RawChunkSize];
+	}
+
+	//the first symbol may start the next independent block (the chunk before was incompressible), the chunk doesn't reach into the one after
+	if (!ReadToken(inputStream, storedSymbols[0]))
+		return false;
+
+	int chunkSize = (blockSymbols > 0 && nextBlockStart - symbolsProcessed < RawChunkSize) ? nextBlockStart - symbolsProcessed : RawChunkSize;
+	int count = 1;
+	while (count < chunkSize && ReadToken(inputStream, storedSymbols[count]))
+	{
+		count++;
+	}
+
+	WriteStoredBlock(storedSymbols, count);
+	symbolsProcessed += count;
+	chunkStrategies.Add(StoredStrategy);
+
+	//long-range matches inside the chunk are not written
+	if (longRangeMatcher != NULL)
+	{
+		longRangeMatcher->SkipMatches(symbolsProcessed);
+	}
+
+	return true;
+}
+
+template <typename T, int WindowBits>
+inline bool SuffixTree<T, WindowBits>::ChunkEnds()
+{
+	return chunkLength == RawChunkSize || (blockSymbols > 0 && symbolsProcessed >= nextBlockStart);
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::StartChunk()
+{
+	outputBytesHelper->SetMark();
+	chunkStartBits = outputBytesHelper->GetAppendedBits();
+	chunkStartEncoder = encoder;
+	chunkStorable = !outputSuppressed;
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::EndChunk(TokenInputStream * inputStream)
+{
+	if (!storedBlocks)
+	{
+		chunkStrategies.Add(LevelStrategy);
+		chunkLength = 0;
+		return;
+	}
+
+	//the pending match is the last item of the chunk
+	if (matchHelper.GetMatchLength() > 0)
+	{
+		WriteMatch();
+	}
+	matchAfterLongestSufixRemoval = false;
+
+	//the symbols stay in the tree, so the stored block is windowed - the decoder puts them into its window too
+	long long storedBits = (sequences ? OutputBytesHelper<T>::LiteralRunBits : 1) + encoder.GetMatchBits() + 8 * StoredBlock<T>::ExtraBytesCount + 8 * sizeof(T) * (long long)chunkLength;
+	if (chunkStorable && !outputSuppressed && outputBytesHelper->GetAppendedBits() - chunkStartBits > storedBits)
+	{
+		outputBytesHelper->RewindToMark();
+		encoder = chunkStartEncoder;
+		WriteStoredBlock(chunkSymbols, chunkLength, true);
+		chunkStrategies.Add(StoredStrategy);
+	}
+	else
+	{
+		chunkStrategies.Add(LevelStrategy);
+	}
+
+	outputBytesHelper->ReleaseMark();
+
+	//tokens are not known ahead as raw symbols, so the literals of the chunk stand for the next one
+	if (entropyCoding && (inputStream != NULL || longRangeMatcher != NULL))
+	{
+		outputBytesHelper->SetLiteralBits(StoredBlock<T>::EntropyCodedLiteralBits(chunkSymbols, chunkLength));
+	}
+
+	chunkLength = 0;
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::StartBlock(TokenInputStream * inputStream)
+{
+	//the block ends the same way as the whole output
+	if (symbolsProcessed > 0)
+	{
+		if (matchHelper.GetMatchLength() > 0)
+		{
+			WriteMatch();
+		}
+
+		outputBytesHelper->EndBlock(EncodeMatch(matchHelper.GetMatchWithZeroLength(outputBytesHelper->GetRemainingFlagsCount())));
+		encoder.ResetRepeatOffsets();
+		RestartWindow();
+	}
+
+	//the ended block gets its checksums, data in front of the first block are not covered
+	if (checksums)
+	{
+		if (blockIndex.GetCount() > 0)
+			blockIndex.SetLastChecksums(outStream.TakeChecksum(), contentChecksum.GetValue());
+		else
+			outStream.StartChecksum();
+
+		contentChecksum.Reset();
+	}
+
+	BlockIndexEntry entry;
+	entry.CompressedOffset = outStream.GetBytesWritten();
+	entry.SymbolOffset = symbolsProcessed;
+	entry.ByteOffset = (inputStream != NULL) ? inputStream->tokenBytesRead : symbolsProcessed * sizeof(T);
+	entry.CompressedChecksum = entry.ContentChecksum = 0;
+	blockIndex.Add(entry);
+
+	nextBlockStart = symbolsProcessed + blockSymbols;
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::RestartWindow()
+{
+	HugePageAllocator::DeleteArray(leaves, windowSize);
+	delete (vertexPool);
+	delete (bot);
+
+	buffer->Reset();
+	activePoint = ActivePoint();
+	matchAfterLongestSufixRemoval = false;
+	CreateEmptyGraph();
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::AppendDecodedSymbol(T symbol, TokenOutputStream * outputStream)
+{
+	buffer->AppendSymbolToSlidingWindow(symbol);
+
+	//symbols are written out right away, the full buffer only drops the oldest one
+	if (buffer->SlidingWindowIsEmptyWhileDecoding())
+	{
+		buffer->MoveBackForward();
+	}
+
+	WriteDecodedSymbol(symbol, outputStream);
+}
+
+template <typename T, int WindowBits>
+inline void SuffixTree<T, WindowBits>::WriteDecodedSymbol(T symbol, TokenOutputStream * outputStream)
+{
+	if (keepHistory)
+	{
+		history.push_back(symbol);
+	}
+
+	if (checksums)
+	{
+		contentChecksum.UpdateSymbol(symbol);
+	}
+
+	if (outputStream != NULL)
+	{
+		outputStream->WriteToken(symbol);
+	}
+	else if (writeOutput)
+	{
+		outStream.WriteSymbol(symbol);
+	}
+}
+
+template <typename T, int WindowBits>
+inline void SuffixTree<T, WindowBits>::ReadLengthExtension(Match & match, short lengthBits, BitReader & reader)
+{
+	if (Decoder::IsExtended(match, lengthBits))
+	{
+		short extensionByte = 0;
+		while (Decoder::ExtendLength(match, (uchar)reader.Read(8), extensionByte))
+		{
+			extensionByte++;
+		}
+	}
+}
+
+template <typename T, int WindowBits>
+inline Match SuffixTree<T, WindowBits>::ReadMatch(BitReader & reader)
+{
+	Match match;
+	if (decoder.HasRepeatCodes() && reader.Read(1))
+		match = decoder.DecodeRepeatMatch(reader.Read(RepeatOffsets::SlotBits + MatchLengthBits()));
+	else
+		match = DecodeMatch(reader.Read(MatchBits()));
+
+	ReadLengthExtension(match, MatchLengthBits(), reader);
+	return match;
+}
+
+template <typename T, int WindowBits>
+inline void SuffixTree<T, WindowBits>::CopyMatch(Match match, TokenOutputStream * outputStream)
+{
+	decoder.UpdateRepeatOffsets(match.MatchIndex);
+	buffer->SetMatchIndex(match.MatchIndex);
+	for (int j = 0; j < match.MatchLength; j++)
+	{
+		T decodedSymbol = buffer->AppendMatchSymbol();
+
+		if (buffer->SlidingWindowIsEmptyWhileDecoding())
+		{
+			buffer->MoveBackForward();
+		}
+
+		WriteDecodedSymbol(decodedSymbol, outputStream);
+	}
+}
+
+template <typename T, int WindowBits>
+inline int SuffixTree<T, WindowBits>::DecodeLiteralRun(TokenOutputStream * outputStream)
+{
+	Match run = Match(0, (int)inStream.ReadBits(OutputBytesHelper<T>::LiteralRunBits));
+	ReadLengthExtension(run, OutputBytesHelper<T>::LiteralRunBits, inStream.GetBitReader());
+
+	//the fill in front of the sequence covers half of MaxFieldsBytes of literals and the match behind them
+	const int literalsPerFill = InStream<T>::MaxFieldsBytes / 2 / sizeof(T);
+	for (int j = 0; j < run.MatchLength; j++)
+	{
+		if (j > 0 && j % literalsPerFill == 0)
+		{
+			inStream.FillBits();
+		}
+
+		AppendDecodedSymbol((T)inStream.ReadBits(8 * sizeof(T)), outputStream);
+	}
+
+	return run.MatchLength;
+}
+
+template <typename T, int WindowBits>
+int SuffixTree<T, WindowBits>::ReadStoredBlockLength(BitReader & reader, bool & windowed)
+{
+	uchar extraBytes[StoredBlock<T>::ExtraBytesCount];
+	for (short j = 0; j < StoredBlock<T>::ExtraBytesCount; j++)
+	{
+		extraBytes[j] = (uchar)reader.Read(8);
+	}
+
+	windowed = StoredBlock<T>::IsWindowed(extraBytes);
+	return StoredBlock<T>::DecodeLength(extraBytes);
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::DecodeStoredBlock(TokenOutputStream * outputStream)
+{
+	bool windowed;
+	int length = ReadStoredBlockLength(inStream.GetBitReader(), windowed);
+	for (int j = 0; j < length; j++)
+	{
+		inStream.FillBits();
+		T symbol = (T)inStream.ReadBits(8 * sizeof(T));
+
+		if (windowed)
+			AppendDecodedSymbol(symbol, outputStream);
+		else
+			WriteDecodedSymbol(symbol, outputStream);
+	}
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::DecodeLongRangeMatch(BitReader & reader, TokenOutputStream * outputStream)
+{
+	if (!keepHistory)
+	{
+		fprintf(stderr, "FATAL:\tThe file contains long-range references - decompress it with long-range option\n");
+		exit(1);
+	}
+
+	uchar extraBytes[LongRangeMatcher<T>::ExtraBytesCount];
+	for (short j = 0; j < LongRangeMatcher<T>::ExtraBytesCount; j++)
+	{
+		extraBytes[j] = (uchar)reader.Read(8);
+	}
+
+	long long distance;
+	int length;
+	LongRangeMatcher<T>::DecodeExtraBytes(extraBytes, distance, length);
+	for (int j = 0; j < length; j++)
+	{
+		AppendDecodedSymbol(history[history.size() - distance], outputStream);
+	}
+}
+
+template <typename T, int WindowBits>
+int SuffixTree<T, WindowBits>::ReadSplitBlock()
+{
+	inStream.AlignToByte();
+	inStream.FillBits();
+	int itemsCount = (int)inStream.ReadBits(OutputBytesHelper<T>::SplitCountBits);
+	int literalsBytes = (int)inStream.ReadBits(OutputBytesHelper<T>::SplitCountBits);
+	int matchesBytes = (int)inStream.ReadBits(OutputBytesHelper<T>::SplitCountBits);
+
+	//flags are read by whole 64-bit words, the readers may touch the padding behind every sub-stream
+	int flagsBytes = (itemsCount + 7) / 8;
+	splitFlags.assign((itemsCount + 63) / 64 * 8 + BitReader::PaddingBytes, 0);
+	splitLiterals.assign(literalsBytes + BitReader::PaddingBytes, 0);
+	splitMatches.assign(matchesBytes + BitReader::PaddingBytes, 0);
+
+	inStream.ReadBytes(splitFlags.data(), flagsBytes);
+	inStream.ReadBytes(splitLiterals.data(), literalsBytes);
+	inStream.ReadBytes(splitMatches.data(), matchesBytes);
+
+	return itemsCount;
+}
+
+template <typename T, int WindowBits>
+bool SuffixTree<T, WindowBits>::DecodeSplitBlock(TokenOutputStream * outputStream)
+{
+	int itemsCount = ReadSplitBlock();
+	BitReader flagsReader(splitFlags.data());
+	BitReader literalsReader(splitLiterals.data());
+	BitReader matchesReader(splitMatches.data());
+	unsigned long long flags = 0;
+
+	for (int i = 0; i < itemsCount; i++)
+	{
+		if ((i & 63) == 0)
+		{
+			flags = flagsReader.Read(64);
+		}
+
+		bool literal = (flags >> 63) != 0;
+		flags <<= 1;
+
+		if (literal)
+		{
+			AppendDecodedSymbol((T)literalsReader.Read(8 * sizeof(T)), outputStream);
+			continue;
+		}
+
+		Match match = ReadMatch(matchesReader);
+		if (match.MatchLength > 0)
+		{
+			CopyMatch(match, outputStream);
+		}
+		else if (match.MatchIndex == StoredBlock<T>::MarkerIndex)
+		{
+			bool windowed;
+			int length = ReadStoredBlockLength(matchesReader, windowed);
+			for (int j = 0; j < length; j++)
+			{
+				T symbol = (T)literalsReader.Read(8 * sizeof(T));
+
+				if (windowed)
+					AppendDecodedSymbol(symbol, outputStream);
+				else
+					WriteDecodedSymbol(symbol, outputStream);
+			}
+		}
+		else if (match.MatchIndex == LongRangeMatcher<T>::MarkerIndex)
+		{
+			DecodeLongRangeMatch(matchesReader, outputStream);
+		}
+		else
+		{
+			//the end of data is the last item of the block
+			return true;
+		}
+	}
+
+	return false;
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::ChangeMatchPositionToNew(VertexBase * child, VertexBase * parent)
 {
 	//update match position only if the parent (i.e. the vertex from which match position is enduced) and the oldest leaf have the same offset
 	if (matchHelper.GetMatchLength() > 0)// && activePoint.end->offsetOnBuffer == oldestLeaf->offsetOnBuffer)
 	{
 		int offsetDifference = child->offsetInBuffer - parent->offsetInBuffer;
-		if (offsetDifference < 0) offsetDifference += 2 * windowSize;
+		if (offsetDifference < 0) offsetDifference += BufferSize();
 
 		matchHelper.MatchPosition += offsetDifference;
 		matchHelper.MatchBufPosition += offsetDifference;
-		if (matchHelper.MatchPosition > 2 * windowSize) matchHelper.MatchPosition -= 2 * windowSize;
-		if (matchHelper.MatchBufPosition > 2 * windowSize) matchHelper.MatchBufPosition -= 2 * windowSize;
+		if (matchHelper.MatchPosition > BufferSize()) matchHelper.MatchPosition -= BufferSize();
+		if (matchHelper.MatchBufPosition > BufferSize()) matchHelper.MatchBufPosition -= BufferSize();
 	}
 }
 
-template <typename T>
-void SuffixTree<T>::UpdateOffsets()
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::CompactTree()
 {
-	this->root->UpdateOffset();
+	this->root = this->vertexPool->Compact(this->root);
 
-	if (activePoint.end != NULL)
+	this->activePoint.start = static_cast<VertexChild*>(this->vertexPool->Relocate(this->activePoint.start));
+	this->activePoint.end = this->vertexPool->Relocate(this->activePoint.end);
+	this->lastVertexWithoutSuffixLinkEnd = static_cast<Vertex<T>*>(this->vertexPool->Relocate(this->lastVertexWithoutSuffixLinkEnd));
+}
+
+template <typename T, int WindowBits>
+void SuffixTree<T, WindowBits>::UpdateOffsets(VertexBase * vertex, int offset)
+{
+	while (vertex != this->root)
 	{
-		//I need refreshed offset + depth of vertex (impl/expl), where the match started - need to get current position of AP (vertex offset+depth, AP length) and substract offset length
-		int newMatchBufPosition = activePoint.end->offsetInBuffer + static_cast<Vertex<T>*>(activePoint.start)->depthInTree + activePoint.length - matchHelper.GetMatchLength();
+		Vertex<T> * current = static_cast<Vertex<T>*>(vertex);
 
-		//and if this value is different from 
-		if (matchHelper.GetMatchLength() > 0)
-		{
-			//if match is nonzero and is longer than is current depth of active point, write out (because the offset would change)
-			if (matchHelper.GetMatchLength() > static_cast<Vertex<T>*>(activePoint.start)->depthInTree + activePoint.length)
-			{
-				WriteMatch();
-				matchAfterLongestSufixRemoval = false;
-			}
-			else if (newMatchBufPosition != matchHelper.MatchBufPosition)
-			{
-				int offsetDiff = newMatchBufPosition - matchHelper.MatchBufPosition;
-				if (offsetDiff < 0) offsetDiff += 2 * windowSize;
+		if (buffer->IsOffsetNewer(offset, current->offsetInBuffer))
+			current->offsetInBuffer = offset;
+		else
+			offset = current->offsetInBuffer;
 
-				matchHelper.MatchPosition += offsetDiff;
-				if (matchHelper.MatchPosition >= 2 * windowSize) matchHelper.MatchPosition -= 2 * windowSize;
-				matchHelper.MatchBufPosition = activePoint.end->offsetInBuffer;
-			}
+		//the first update only takes the credit, the second one is passed further
+		if (!current->credit)
+		{
+			current->credit = true;
+			return;
 		}
+
+		current->credit = false;
+		vertex = current->parent;
 	}
+}
+
+template <typename T, int WindowBits>
+inline int SuffixTree<T, WindowBits>::WindowSize()
+{
+	return (WindowBits > 0) ? (1 << WindowBits) : this->windowSize;
+}
+
+template <typename T, int WindowBits>
+inline int SuffixTree<T, WindowBits>::BufferSize()
+{
+	return 2 * WindowSize();
+}
+
+template <typename T, int WindowBits>
+inline short SuffixTree<T, WindowBits>::MatchBits()
+{
+	return (WindowBits > 0) ? FixedMatchBits : this->matchBits;
+}
+
+template <typename T, int WindowBits>
+inline short SuffixTree<T, WindowBits>::MatchLengthBits()
+{
+	return (WindowBits > 0) ? FixedMatchLengthBits : this->matchLengthBits;
+}
+
+template <typename T, int WindowBits>
+inline unsigned long long SuffixTree<T, WindowBits>::EncodeMatch(Match match)
+{
+	if (WindowBits > 0)
+		return Encoder::EncodeMatch<FixedMatchLengthBits>(match);
+
+	return encoder.EncodeMatch(match);
+}
+
+template <typename T, int WindowBits>
+inline Match SuffixTree<T, WindowBits>::DecodeMatch(unsigned long long code)
+{
+	if (WindowBits > 0)
+		return Decoder::DecodeMatch<FixedMatchLengthBits>(code);
+
+	return decoder.DecodeMatch(code);
 }
\ No newline at end of file
@@ -1,16 +1,26 @@
 #pragma once
 #include "TokenInputStream.h"
 #include "TokenOutputStream.h"
+#include "FrameHeader.h"
 
 class SuffixTreeAux
 {
 public:
-	virtual void InitForCompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile) = 0;
-	virtual void InitForDecompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile) = 0;
+	virtual ~SuffixTreeAux() {}
+	virtual void InitForCompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile, bool compactTree, bool longRange, bool repeatOffsets, bool sequences, bool splitStreams) = 0;
+	virtual void InitForDecompression(const char * inFile, const char * outFile, short matchLengthSizeBits, bool binaryFile, bool longRange, bool repeatOffsets, bool sequences, bool splitStreams) = 0;
+	virtual void LoadReference(const char * referenceFile, const vector<int> * referenceTokens) = 0;
+	virtual void SkipInput(long long bytes) = 0;
+	virtual void WriteFrameHeader(FrameHeader header) = 0;
+	virtual void SetIndependentBlocks(int blockSymbols) = 0;
+	virtual void SetBlocksToDecode(int count) = 0;
+	virtual void SetChecksums(bool checksums) = 0;
+	virtual void SetEntropyCoding(bool entropyCoding) = 0;
+	virtual const vector<unsigned int>& GetDecodedChecksums() const = 0;
 	virtual void FinishCompression() = 0;
 	virtual void FinishDecompression() = 0;
-	virtual void Compress(long int inputFileSize, bool showProgress, TokenInputStream * inputStream) = 0;
-	virtual void Decompress(long int inputFileSize, bool showProgress, TokenOutputStream * outputStream) = 0;
+	virtual void Compress(long long inputFileSize, bool showProgress, TokenInputStream * inputStream, double timeBudget) = 0;
+	virtual void Decompress(long long inputFileSize, bool showProgress, TokenOutputStream * outputStream) = 0;
 	virtual void WriteCompressionStatistics() = 0;
 	virtual void WriteDecompressionStatistics() = 0;
 };
\ No newline at end of file
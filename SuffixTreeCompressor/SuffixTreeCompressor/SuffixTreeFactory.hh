@@ -0,0 +1,87 @@
+#pragma once
+#include "SuffixTree.hh"
+#include "SuffixTreeAux.hh"
+#include "BlockCompressor.hh"
+#include "SuffixArrayMatchFinder.hh"
+#include "HashChainMatchFinder.hh"
+#include "CompressionLevel.h"
+
+/**
+ * <summary> Creates compressors for given compression level. Suffix trees for the default window size (2^17 symbols) and
+ *  its neighbours with symbols up to 4 bytes are specialized at compile time, all other configurations get the generic one
+ *  - every specialized size is another copy of the whole tree in the binary.</summary>
+ */
+
+ //Declaration----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+class SuffixTreeFactory
+{
+	public:
+		/**
+		 * <summary> Creates compressor for given symbol type.</summary>
+		 *
+		 * <param name="windowSize">	  Size of the sliding window.</param>
+		 * <param name="windowSizeBits">  The sliding window size in bits.</param>
+		 * <param name="matchLengthBits"> The number of bits that are occupied by match length.</param>
+		 * <param name="level">			  Settings of the compression level.</param>
+		 *
+		 * <returns> The compressor.</returns>
+		 */
+
+		template <typename T>
+		static SuffixTreeAux * Create(int windowSize, short windowSizeBits, short matchLengthBits, const CompressionLevel & level);
+
+	private:
+		/**
+		 * <summary> Creates suffix tree for given symbol type.</summary>
+		 *
+		 * <param name="windowSize">	  Size of the sliding window.</param>
+		 * <param name="windowSizeBits">  The sliding window size in bits.</param>
+		 * <param name="matchLengthBits"> The number of bits that are occupied by match length.</param>
+		 *
+		 * <returns> The suffix tree.</returns>
+		 */
+
+		template <typename T>
+		static SuffixTreeAux * CreateSuffixTree(int windowSize, short windowSizeBits, short matchLengthBits);
+};
+
+//Definition----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+SuffixTreeAux * SuffixTreeFactory::Create(int windowSize, short windowSizeBits, short matchLengthBits, const CompressionLevel & level)
+{
+	//history of one window is kept in front of every block
+	switch (level.Engine)
+	{
+		case SuffixArrayEngine:
+			return new BlockCompressor<T>(new SuffixArrayMatchFinder<T>(2 * windowSize), windowSize, windowSizeBits, matchLengthBits, level.Parsing);
+		case HashChainEngine:
+			return new BlockCompressor<T>(new HashChainMatchFinder<T>(2 * windowSize, level.ChainDepth, (1 << matchLengthBits) - 1, level.Sparse), windowSize, windowSizeBits, matchLengthBits, level.Parsing);
+		default:
+			return CreateSuffixTree<T>(windowSize, windowSizeBits, matchLengthBits);
+	}
+}
+
+template <typename T>
+SuffixTreeAux * SuffixTreeFactory::CreateSuffixTree(int windowSize, short windowSizeBits, short matchLengthBits)
+{
+	//specialized trees have the default match length bits built in
+	if (matchLengthBits == 7 - windowSizeBits % 8)
+	{
+		switch (windowSizeBits)
+		{
+			case 16: return new SuffixTree<T, 16>(windowSize, windowSizeBits, matchLengthBits);
+			case 17: return new SuffixTree<T, 17>(windowSize, windowSizeBits, matchLengthBits);
+			case 18: return new SuffixTree<T, 18>(windowSize, windowSizeBits, matchLengthBits);
+		}
+	}
+
+	return new SuffixTree<T>(windowSize, windowSizeBits, matchLengthBits);
+}
+
+template <>
+inline SuffixTreeAux * SuffixTreeFactory::CreateSuffixTree<unsigned long long>(int windowSize, short windowSizeBits, short matchLengthBits)
+{
+	return new SuffixTree<unsigned long long>(windowSize, windowSizeBits, matchLengthBits);
+}
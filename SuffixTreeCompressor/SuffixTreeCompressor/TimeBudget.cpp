@@ -0,0 +1,40 @@
+#include "TimeBudget.h"
+
+TimeBudget::TimeBudget(double seconds, long long totalSymbols)
+{
+	this->seconds = seconds;
+	this->totalSymbols = totalSymbols;
+	this->switchSymbols = 0;
+	this->startTime = this->switchTime = chrono::steady_clock::now();
+}
+
+bool TimeBudget::IsAtRisk(long long symbolsProcessed)
+{
+	double elapsed = SecondsSince(startTime);
+	if (elapsed >= seconds)
+		return true;
+
+	long long measuredSymbols = symbolsProcessed - switchSymbols;
+	double measuredSeconds = SecondsSince(switchTime);
+	if (measuredSymbols < MinMeasuredSymbols || measuredSeconds <= 0)
+		return false;
+
+	double remainingSeconds = (double)(totalSymbols - symbolsProcessed) * measuredSeconds / measuredSymbols;
+	return elapsed + remainingSeconds > seconds;
+}
+
+void TimeBudget::Switched(long long symbolsProcessed)
+{
+	this->switchSymbols = symbolsProcessed;
+	this->switchTime = chrono::steady_clock::now();
+}
+
+double TimeBudget::GetElapsedSeconds()
+{
+	return SecondsSince(startTime);
+}
+
+double TimeBudget::SecondsSince(chrono::time_point<chrono::steady_clock> time)
+{
+	return (double)chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - time).count() / 1000000;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <chrono>
+
+using namespace std;
+
+/**
+ * <summary> Watches throughput of compression against a time budget. The pace is measured since the last switch of
+ *  strategy, so a faster strategy gets its own estimate.</summary>
+ */
+
+class TimeBudget
+{
+	public:
+		static const long long MinMeasuredSymbols = 1 << 16;	///< Symbols that have to be processed to estimate pace
+
+		/**
+		 * <summary> Constructor - starts the clock.</summary>
+		 *
+		 * <param name="seconds">	   The time budget in seconds.</param>
+		 * <param name="totalSymbols"> Number of symbols of the whole input.</param>
+		 */
+
+		TimeBudget(double seconds, long long totalSymbols);
+
+		/**
+		 * <summary> Checks whether the rest of the input would be finished in time with the current pace.</summary>
+		 *
+		 * <param name="symbolsProcessed"> Number of symbols processed so far.</param>
+		 *
+		 * <returns> True if the budget is at risk.</returns>
+		 */
+
+		bool IsAtRisk(long long symbolsProcessed);
+
+		/**
+		 * <summary> Marks switch to a faster strategy - pace is measured again from now.</summary>
+		 *
+		 * <param name="symbolsProcessed"> Number of symbols processed so far.</param>
+		 */
+
+		void Switched(long long symbolsProcessed);
+
+		/**
+		 * <summary> Gets time elapsed since start.</summary>
+		 *
+		 * <returns> The elapsed seconds.</returns>
+		 */
+
+		double GetElapsedSeconds();
+
+	private:
+		double seconds;				///< The time budget in seconds
+		long long totalSymbols;		///< Number of symbols of the whole input
+		long long switchSymbols;	///< Number of symbols processed at the last switch
+		chrono::time_point<chrono::steady_clock> startTime;		///< Start of compression
+		chrono::time_point<chrono::steady_clock> switchTime;	///< Time of the last switch
+
+		/**
+		 * <summary> Gets seconds elapsed since given time.</summary>
+		 *
+		 * <param name="time"> The time.</param>
+		 *
+		 * <returns> The elapsed seconds.</returns>
+		 */
+
+		static double SecondsSince(chrono::time_point<chrono::steady_clock> time);
+};
@@ -1,4 +1,5 @@
 #include "TokenInputStream.h"
+#include <iostream>
 
 TokenInputStream::TokenInputStream(const string& InputFilePath, const string& TokenDictionaryFilePath)
 {
@@ -11,16 +12,53 @@ TokenInputStream::TokenInputStream(const string& InputFilePath, const string& To
 	ReadChar();
 }
 
+TokenInputStream::TokenInputStream(const string& InputFilePath, const string& TokenDictionaryFilePath, const string& ReferenceFilePath)
+{
+	bytesRead = 0;
+	CreateTokenDictionary(ReferenceFilePath, &referenceTokens);
+	CreateTokenDictionary(InputFilePath);
+	StoreTokenDictionary(TokenDictionaryFilePath);
+	inFile.open(InputFilePath, wifstream::binary);
+	inFile >> noskipws;
+	currentState = InitState;
+	ReadChar();
+}
+
+TokenInputStream::TokenInputStream(const string& InputFilePath, const string& TokenDictionaryFilePath, const string& InitialDictionaryFilePath, long long InputOffset)
+{
+	bytesRead = 0;
+	LoadTokenDictionary(InitialDictionaryFilePath);
+	CreateTokenDictionary(InputFilePath, NULL, InputOffset);
+	StoreTokenDictionary(TokenDictionaryFilePath);
+	inFile.open(InputFilePath, wifstream::binary);
+	inFile.seekg(InputOffset);
+	inFile >> noskipws;
+	currentState = InitState;
+	ReadChar();
+}
+
+TokenInputStream::TokenInputStream(const string& ReferenceFilePath, const TokenOutputStream& Dictionary)
+{
+	bytesRead = 0;
+	for (int i = 0; i < Dictionary.NumberOfTokens(); i++)
+	{
+		tokenDictionary.emplace(Dictionary.GetToken(i), i);
+	}
+
+	TokenizeFile(ReferenceFilePath, 0, referenceTokens);
+}
+
 TokenInputStream::~TokenInputStream()
 {
 	inFile.close();
 }
 
-void TokenInputStream::CreateTokenDictionary(const string& InputFilePath)
+void TokenInputStream::CreateTokenDictionary(const string& InputFilePath, vector<int>* Tokens, long long Offset)
 {
 	string Token;
-	int TokenIdCounter = 0;
+	int TokenIdCounter = tokenDictionary.size();
 	inFile.open(InputFilePath, wifstream::binary);
+	inFile.seekg(Offset);
 	inFile >> noskipws;
 	currentState = InitState;
 	ReadChar();
@@ -31,7 +69,11 @@ void TokenInputStream::CreateTokenDictionary(const string& InputFilePath)
 			tokenDictionary.emplace(Token, TokenIdCounter);
 			TokenIdCounter += 1;
 		}
-		tokensTotal++;
+
+		if (Tokens != NULL)
+			Tokens->push_back(tokenDictionary[Token]);
+		else
+			tokensTotal++;
 	}
 	inFile.close();
 }
@@ -95,6 +137,29 @@ bool TokenInputStream::ParseToken(string& Token)
 	return bRet;
 }
 
+void TokenInputStream::TokenizeFile(const string& FilePath, long long Offset, vector<int>& Tokens)
+{
+	string Token;
+	inFile.close();
+	inFile.clear();
+	inFile.open(FilePath, wifstream::binary);
+	inFile.seekg(Offset);
+	inFile >> noskipws;
+	currentState = InitState;
+	ReadChar();
+	while (ParseToken(Token))
+	{
+		auto found = tokenDictionary.find(Token);
+		if (found == tokenDictionary.end())
+		{
+			cerr << "File " << FilePath << " has token that is not in the dictionary." << endl;
+			exit(1);
+		}
+		Tokens.push_back(found->second);
+	}
+	inFile.close();
+}
+
 void TokenInputStream::ReadChar()
 {
 	if (inFile.get(lastCharacter))
@@ -127,3 +192,22 @@ void TokenInputStream::StoreTokenDictionary(const string& TokenDictionaryFilePat
 	}
 	output.close();
 }
+
+void TokenInputStream::LoadTokenDictionary(const string& TokenDictionaryFilePath)
+{
+	ifstream input(TokenDictionaryFilePath, ios::in | ios::binary);
+	int DictionarySize;
+	input.read(reinterpret_cast<char *>(&DictionarySize), sizeof(int));
+	vector<int> TokenIdBuffer(DictionarySize);
+	input.read(reinterpret_cast<char *>(TokenIdBuffer.data()), sizeof(int) * DictionarySize);
+	string Token;
+	for (int i = 0; i < DictionarySize; i++)
+	{
+		int size;
+		input.read(reinterpret_cast<char *>(&size), sizeof(int));
+		Token.resize(size);
+		input.read(&Token[0], size);
+		tokenDictionary.emplace(Token, TokenIdBuffer[i]);
+	}
+	input.close();
+}
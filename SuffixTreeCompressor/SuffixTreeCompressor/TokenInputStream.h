@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "TokenStreamBase.h"
+#include "TokenOutputStream.h"
 
 using namespace std;
 
@@ -12,15 +13,21 @@ class TokenInputStream : public TokenStreamBase
 {
 public:
 	TokenInputStream(const string& InputFilePath, const string& TokenDictionaryFilePath);
+	TokenInputStream(const string& InputFilePath, const string& TokenDictionaryFilePath, const string& ReferenceFilePath);
+	TokenInputStream(const string& InputFilePath, const string& TokenDictionaryFilePath, const string& InitialDictionaryFilePath, long long InputOffset);
+	TokenInputStream(const string& ReferenceFilePath, const TokenOutputStream& Dictionary);
 	~TokenInputStream();
 
 	int ReadToken();
 
 	int NumberOfTokens() const;
 	bool FileEnd();
+	void TokenizeFile(const string& FilePath, long long Offset, vector<int>& Tokens);
 
-	int tokensTotal = 0;
-	int bytesRead;
+	long long tokensTotal = 0;
+	long long bytesRead;
+	long long tokenBytesRead = 0;
+	vector<int> referenceTokens;
 
 private:
 	enum CharacterClasses
@@ -38,10 +45,11 @@ private:
 		EndOfFileState
 	};
 
-	void CreateTokenDictionary(const string& InputFilePath);
+	void CreateTokenDictionary(const string& InputFilePath, vector<int>* Tokens = NULL, long long Offset = 0);
 	bool ParseToken(string& Token);
 	void ReadChar();
 	void StoreTokenDictionary(const string& TokenDictionaryFilePath);
+	void LoadTokenDictionary(const string& TokenDictionaryFilePath);
 
 	wifstream inFile;
 	States currentState;
@@ -60,9 +68,10 @@ inline int TokenInputStream::ReadToken()
 	string Token;
 	if (ParseToken(Token))
 	{
+		tokenBytesRead += Token.size();
 		return tokenDictionary[Token];
 	}
-	return 255;
+	return -1;
 }
 
 inline int TokenInputStream::NumberOfTokens() const
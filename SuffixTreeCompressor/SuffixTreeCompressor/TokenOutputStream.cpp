@@ -1,8 +1,8 @@
 #include "TokenOutputStream.h"
 
-TokenOutputStream::TokenOutputStream(const string& OutputFilePath, const string& TokenDictionaryFilePath)
+TokenOutputStream::TokenOutputStream(const string& OutputFilePath, const string& TokenDictionaryFilePath, long long DictionaryOffset)
 {
-	LoadTokenDictionary(TokenDictionaryFilePath);
+	LoadTokenDictionary(TokenDictionaryFilePath, DictionaryOffset);
 	outFile.open(OutputFilePath);
 }
 
@@ -11,9 +11,11 @@ TokenOutputStream::~TokenOutputStream()
 	outFile.close();
 }
 
-void TokenOutputStream::LoadTokenDictionary(const string& TokenDictionaryFilePath)
+void TokenOutputStream::LoadTokenDictionary(const string& TokenDictionaryFilePath, long long DictionaryOffset)
 {
+	//dictionaries of merged frames follow each other in one file
 	ifstream input(TokenDictionaryFilePath, ios::in | ios::binary);
+	input.seekg(DictionaryOffset);
 	int DictionarySize;
 	input.read(reinterpret_cast<char *>(&DictionarySize), sizeof(int));
 	int *TokenIdBuffer = new int[DictionarySize];
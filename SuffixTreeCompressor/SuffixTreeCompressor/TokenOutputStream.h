@@ -10,15 +10,17 @@ using namespace std;
 class TokenOutputStream : public TokenStreamBase
 {
 public:
-	TokenOutputStream(const string& OutputFilePath, const string& TokenDictionaryFilePath);
+	TokenOutputStream(const string& OutputFilePath, const string& TokenDictionaryFilePath, long long DictionaryOffset = 0);
 	~TokenOutputStream();
 
 	void WriteToken(const int TokenId);
+	void Close();
 
 	int NumberOfTokens() const;
+	const string& GetToken(const int TokenId) const;
 
 private:
-	void LoadTokenDictionary(const string& TokenDictionaryFilePath);
+	void LoadTokenDictionary(const string& TokenDictionaryFilePath, long long DictionaryOffset);
 
 	ofstream outFile;
 	vector<string> tokenDictionary;
@@ -30,7 +32,17 @@ inline void TokenOutputStream::WriteToken(const int TokenId)
 	outFile.write(tokenDictionary[TokenId].c_str(), tokenDictionary[TokenId].size());
 }
 
+inline void TokenOutputStream::Close()
+{
+	outFile.close();
+}
+
 inline int TokenOutputStream::NumberOfTokens() const
 {
 	return tokenDictionary.size();
+}
+
+inline const string& TokenOutputStream::GetToken(const int TokenId) const
+{
+	return tokenDictionary[TokenId];
 }
\ No newline at end of file
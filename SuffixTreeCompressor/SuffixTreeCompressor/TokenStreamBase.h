@@ -2,5 +2,6 @@
 class TokenStreamBase
 {
 public:
+	virtual ~TokenStreamBase() = default;
 	virtual int NumberOfTokens() const = 0;
 };
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+
+/**
+ * <summary> Values that represent the way the input is split into symbols.</summary>
+ */
+
+enum TokenizerEnum
+{
+	ByteTokenizer,	///< Bytes of the file are the symbols (byte mode)
+	WordTokenizer	///< Runs of alphanumeric and other characters are the symbols - IDs from the dictionary
+};
@@ -18,6 +18,8 @@ class Vertex : public VertexChild
 {
 	public:
 		int depthInTree;
+		bool credit;				///< Whether the vertex holds a credit for passing fresh offset to its parent (offsets are maintained incrementally)
+		Vertex() = default;
 		Vertex(int offset);
 		~Vertex() = default;
 
@@ -39,12 +41,6 @@ class Vertex : public VertexChild
 
 		//void WriteVertex(int level, int *frontOrig, int offsetOnBuffer, int prevDepthInSymbols, Buffer* buffer);
 		
-		/**
-		 * <summary> Deletes all children.</summary>
-		 */
-
-		void DeleteChildren();
-
 		/**
 		 * <summary> Searches for the end of edge, that starts with given symbol.</summary>
 		 *
@@ -54,7 +50,8 @@ class Vertex : public VertexChild
 		 * <returns> Vertex that is at the end of edge.</returns>
 		 */
 
-		VertexBase * FindOutEdgeEnd(int symbol, Buffer<T> * buffer);
+		template <int WindowBits>
+		VertexBase * FindOutEdgeEnd(int symbol, Buffer<T, WindowBits> * buffer);
 		
 	private:
 		VertexChild * suffixLink;   ///< The suffix link
@@ -66,7 +63,11 @@ template <typename T>
 Vertex<T>::Vertex(int offset) : VertexChild()
 {
 	this->offsetInBuffer = offset;
+	this->parent = NULL;
 	this->firstChild = NULL;
+	this->suffixLink = NULL;
+	this->depthInTree = 0;
+	this->credit = false;
 }
 
 template <typename T>
@@ -106,25 +107,8 @@ void Vertex<T>::SetSuffixLink(VertexChild * suffixLinkVertex)
 //}
 
 template <typename T>
-void Vertex<T>::DeleteChildren()
-{
-	VertexBase * child = this->firstChild;
-	while (child)
-	{
-		if (typeid(child) == typeid(Vertex))
-		{
-			Vertex * vert = static_cast<Vertex*>(child);
-			vert->DeleteChildren();
-			child = child->nextSibling;
-			delete(vert);
-			continue;
-		}
-		child = child->nextSibling;
-	}
-}
-
-template <typename T>
-VertexBase * Vertex<T>::FindOutEdgeEnd(int symbol, Buffer<T> * buffer)
+template <int WindowBits>
+VertexBase * Vertex<T>::FindOutEdgeEnd(int symbol, Buffer<T, WindowBits> * buffer)
 {
 	VertexBase * child = this->firstChild;
 
@@ -20,12 +20,4 @@ class VertexBase
 		VertexBase() = default;
 		virtual ~VertexBase() = default;
 		//virtual void WriteVertex(int level, int labelStart, int labelEnd, Buffer* buffer);
-
-		/**
-		 * <summary> Updates the vertex offset.</summary>
-		 *
-		 * <returns> Offset of the string that this vertex represents.</returns>
-		 */
-
-		virtual int UpdateOffset() = 0;
 };
\ No newline at end of file
@@ -1,33 +1,6 @@
 
 #include "VertexChild.h"
 
-int VertexChild::UpdateOffset()
-{
-	VertexBase * child = this->firstChild;
-
-	int newestOffset = -1;
-	int offset = -1;
-
-	while (child != NULL)
-	{
-		offset = child->UpdateOffset();
-
-		//at leaves it is sure that all offsets come from that buffer half that is between back and front. Inner vertices can have out-of-date offsets, but leaves not, as when they are created,
-		// their current offsetInBuffer is directed by current position of front and thus it is the newest possible
-		//so we can always compare simply "offset > newestOffset"
-		if (offset > newestOffset)
-		{
-			newestOffset = offset;
-		}
-
-		child = child->nextSibling;
-	}
-
-	this->offsetInBuffer = newestOffset;
-
-	return newestOffset;
-}
-
 void VertexChild::MoveToFront(VertexBase * prevChild, VertexBase * movedChild)
 {
 	prevChild->nextSibling = movedChild->nextSibling;
@@ -13,14 +13,6 @@ class VertexChild :	public VertexBase
 		VertexChild() = default;
 		~VertexChild() = default;
 
-		/**
-		* <summary> Updates the offset of the current vertex.</summary>
-		*
-		* <returns> The freshest offset of all leaves in subtree.</returns>
-		*/
-
-		int UpdateOffset();
-
 		/**
 		* <summary> Move the movedChild to front of children list.</summary>
 		*
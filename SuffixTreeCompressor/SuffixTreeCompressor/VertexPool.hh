@@ -0,0 +1,242 @@
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Vertex.hh"
+#include "HugePageAllocator.h"
+
+/**
+ * <summary> Store for inner vertices of the suffix tree. Vertices live in one array, so that they can be
+ *  renumbered (compacted) in DFS order from time to time - siblings and parent/child pairs then lie close in memory.
+ *  Slots of the array are constructed only when they are handed out for the first time and the arrays for compaction are
+ *  allocated by the first one, so memory that the tree doesn't use is not touched.</summary>
+ */
+
+ //Declaration----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+class VertexPool
+{
+	public:
+		VertexPool(int capacity);
+		~VertexPool();
+
+		/**
+		 * <summary> Takes free vertex from the store.</summary>
+		 *
+		 * <param name="offset"> Offset of the new vertex in buffer.</param>
+		 *
+		 * <returns> The new vertex.</returns>
+		 */
+
+		Vertex<T> * NewVertex(int offset);
+
+		/**
+		 * <summary> Returns vertex back to the store.</summary>
+		 *
+		 * <param name="vertex"> The vertex to be freed.</param>
+		 */
+
+		void DeleteVertex(Vertex<T> * vertex);
+
+		/**
+		 * <summary> Renumbers all vertices reachable from root in DFS order and fixes pointers among vertices and leaves.
+		 *  Pointers kept outside of the tree have to be passed through Relocate afterwards.</summary>
+		 *
+		 * <param name="root"> The root of the suffix tree.</param>
+		 *
+		 * <returns> The relocated root.</returns>
+		 */
+
+		Vertex<T> * Compact(Vertex<T> * root);
+
+		/**
+		 * <summary> Gets new location of the vertex moved by the last compaction.</summary>
+		 *
+		 * <param name="vertex"> The vertex (or leaf, bot, NULL - those are returned untouched).</param>
+		 *
+		 * <returns> The relocated vertex.</returns>
+		 */
+
+		VertexBase * Relocate(VertexBase * vertex);
+
+	private:
+		Vertex<T> * vertices;		///< The vertices currently in use
+		Vertex<T> * spareVertices;	///< The second array - vertices are copied there during compaction (NULL before the first one)
+		int capacity;				///< Number of vertices in each array
+		int usedCount;				///< Number of slots that were handed out at least once (they are constructed)
+		int * freeIndices;			///< Stack of indices of freed vertices below usedCount
+		int freeCount;				///< Number of freed vertices
+		int * newIndices;			///< New index of every vertex after the last compaction (-1 if the vertex was free)
+		Vertex<T> ** stack;			///< Stack for DFS (no recursion - the tree may be very deep)
+
+		/**
+		 * <summary> Destroys the constructed slots of array.</summary>
+		 *
+		 * <param name="items"> The array.</param>
+		 * <param name="count"> Number of constructed slots.</param>
+		 */
+
+		static void DestroyVertices(Vertex<T> * items, int count);
+};
+
+//Definition----------------------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+VertexPool<T>::VertexPool(int capacity)
+{
+	this->capacity = capacity;
+	this->vertices = static_cast<Vertex<T>*>(HugePageAllocator::Allocate(capacity * sizeof(Vertex<T>)));
+	this->spareVertices = NULL;
+	this->usedCount = 0;
+	this->freeIndices = new int[capacity];
+	this->freeCount = 0;
+	this->newIndices = NULL;
+	this->stack = NULL;
+}
+
+template <typename T>
+VertexPool<T>::~VertexPool()
+{
+	DestroyVertices(vertices, usedCount);
+	HugePageAllocator::Free(vertices, capacity * sizeof(Vertex<T>));
+	if (spareVertices != NULL)
+	{
+		HugePageAllocator::Free(spareVertices, capacity * sizeof(Vertex<T>));
+	}
+	delete[] freeIndices;
+	delete[] newIndices;
+	delete[] stack;
+}
+
+template <typename T>
+Vertex<T> * VertexPool<T>::NewVertex(int offset)
+{
+	//freed vertices go first, the array grows only when there are none
+	if (freeCount > 0)
+	{
+		Vertex<T> * vertex = &vertices[freeIndices[--freeCount]];
+		*vertex = Vertex<T>(offset);
+		return vertex;
+	}
+
+	if (usedCount == capacity)
+	{
+		fprintf(stderr, "FATAL:\tSuffix tree vertex store is exhausted\n");
+		exit(1);
+	}
+
+	return new (&vertices[usedCount++]) Vertex<T>(offset);
+}
+
+template <typename T>
+void VertexPool<T>::DeleteVertex(Vertex<T> * vertex)
+{
+	freeIndices[freeCount++] = (int)(vertex - vertices);
+}
+
+template <typename T>
+Vertex<T> * VertexPool<T>::Compact(Vertex<T> * root)
+{
+	if (spareVertices == NULL)
+	{
+		spareVertices = static_cast<Vertex<T>*>(HugePageAllocator::Allocate(capacity * sizeof(Vertex<T>)));
+		newIndices = new int[capacity];
+		stack = new Vertex<T>*[capacity];
+	}
+
+	for (int i = 0; i < usedCount; i++)
+	{
+		newIndices[i] = -1;
+	}
+
+	//number vertices in DFS preorder - children are visited in the order of the list (most recently used first)
+	int count = 0;
+	int stackSize = 0;
+	stack[stackSize++] = root;
+
+	while (stackSize > 0)
+	{
+		Vertex<T> * vertex = stack[--stackSize];
+		newIndices[vertex - vertices] = count++;
+
+		//push children in reverse, so that the first child is popped first
+		int firstPushed = stackSize;
+		for (VertexBase * child = vertex->firstChild; child != NULL; child = child->nextSibling)
+		{
+			Vertex<T> * childVertex = dynamic_cast<Vertex<T>*>(child);
+			if (childVertex)
+			{
+				stack[stackSize++] = childVertex;
+			}
+		}
+		for (int i = firstPushed, j = stackSize - 1; i < j; i++, j--)
+		{
+			Vertex<T> * tmp = stack[i];
+			stack[i] = stack[j];
+			stack[j] = tmp;
+		}
+	}
+
+	//from now on, spareVertices hold the old locations
+	Vertex<T> * oldVertices = vertices;
+	vertices = spareVertices;
+	spareVertices = oldVertices;
+
+	for (int i = 0; i < usedCount; i++)
+	{
+		if (newIndices[i] >= 0)
+		{
+			new (&vertices[newIndices[i]]) Vertex<T>(spareVertices[i]);
+		}
+	}
+
+	//the old array holds only the addresses that are relocated
+	DestroyVertices(spareVertices, usedCount);
+	usedCount = count;
+
+	for (int i = 0; i < count; i++)
+	{
+		Vertex<T> * vertex = &vertices[i];
+		vertex->parent = Relocate(vertex->parent);
+		vertex->nextSibling = Relocate(vertex->nextSibling);
+		vertex->firstChild = Relocate(vertex->firstChild);
+		vertex->SetSuffixLink(static_cast<VertexChild*>(Relocate(vertex->GetSuffixLink())));
+	}
+
+	//leaves are reachable only through children lists - the vertex siblings are already relocated
+	for (int i = 0; i < count; i++)
+	{
+		for (VertexBase * child = vertices[i].firstChild; child != NULL; child = child->nextSibling)
+		{
+			child->parent = &vertices[i];
+			child->nextSibling = Relocate(child->nextSibling);
+		}
+	}
+
+	freeCount = 0;
+
+	return &vertices[0];
+}
+
+template <typename T>
+VertexBase * VertexPool<T>::Relocate(VertexBase * vertex)
+{
+	void * address = vertex;
+
+	if (vertex == NULL || address < (void*)spareVertices || address >= (void*)(spareVertices + capacity))
+	{
+		return vertex;
+	}
+
+	return &vertices[newIndices[static_cast<Vertex<T>*>(vertex) - spareVertices]];
+}
+
+template <typename T>
+void VertexPool<T>::DestroyVertices(Vertex<T> * items, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		items[i].~Vertex<T>();
+	}
+}